@@ -0,0 +1,151 @@
+/**
+ * @file bench.h
+ * @brief Helpers shared by the microbenchmarks.
+ *
+ * Include it before headers.h: it routes the malloc, calloc and realloc
+ * calls of the code under test through counters, so every benchmark can
+ * report the heap allocations an operation makes along with its time.
+ *
+ * Every benchmark prints one row per case and size, and with `-o <file>`
+ * also appends the rows to a CSV file, so the results of two changes can be
+ * compared line by line. The sizes run from __BENCH_MIN__ up to `-n <max>`
+ * (default __BENCH_MAX__), and every random input comes from a fixed seed,
+ * so two runs measure the same work.
+ */
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/******************** MACROS ********************/
+#define __BENCH_MIN__ 100      /**< Smallest size measured */
+#define __BENCH_MAX__ 10000000 /**< Default largest size measured */
+#define __BENCH_SEED__ 42      /**< Seed of every random input */
+#define __BENCH_CSV_HEADER__ "benchmark,case,n,ops,ns_per_op,allocs_per_op\n"
+/************************************************/
+
+/*************** Global Variables ***************/
+static long long benchAllocations;     // NOLINT
+static FILE* benchResults;             // NOLINT
+static long benchMax = __BENCH_MAX__;  // NOLINT
+/************************************************/
+
+/**
+ * @brief Counts and forwards a malloc call.
+ */
+void* Bench_malloc(size_t size) {
+  benchAllocations++;
+  return malloc(size);
+}
+
+/**
+ * @brief Counts and forwards a calloc call.
+ */
+void* Bench_calloc(size_t count, size_t size) {
+  benchAllocations++;
+  return calloc(count, size);
+}
+
+/**
+ * @brief Counts and forwards a realloc call.
+ */
+void* Bench_realloc(void* block, size_t size) {
+  benchAllocations++;
+  return realloc(block, size);
+}
+
+#define malloc(size) Bench_malloc(size)
+#define calloc(count, size) Bench_calloc(count, size)
+#define realloc(block, size) Bench_realloc(block, size)
+
+/**
+ * @brief Returns the monotonic time in nanoseconds.
+ */
+double nowNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/**
+ * @brief Returns the next number of a xorshift generator.
+ *
+ * @param state Pointer to the state, never 0.
+ * @return The next pseudo-random number.
+ */
+unsigned long long Bench_random(unsigned long long* state) {
+  unsigned long long x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+/**
+ * @brief Parses the options of a benchmark and prints the table header.
+ *
+ * - `-o <file>` Append the results to a CSV file.
+ * - `-n <max>` Largest size measured (default __BENCH_MAX__).
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ */
+void Bench_Init(int argc, char* argv[]) {
+  int option;
+  while ((option = getopt(argc, argv, "o:n:")) != -1) {
+    switch (option) {
+      case 'o':
+        benchResults = fopen(optarg, "a");
+        if (benchResults == NULL) {
+          perror(optarg);
+          exit(-1);
+        }
+        fseek(benchResults, 0, SEEK_END);
+        if (ftell(benchResults) == 0) {
+          fputs(__BENCH_CSV_HEADER__, benchResults);
+        }
+        break;
+      case 'n':
+        benchMax = atol(optarg);
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-o results.csv] [-n max_size]\n",
+                argv[0]);
+        exit(-1);
+    }
+  }
+  printf("%-12s %-10s %10s %12s %10s %13s\n", "benchmark", "case", "n",
+         "ops", "ns/op", "allocs/op");
+}
+
+/**
+ * @brief Prints a result and appends it to the results file, if any.
+ *
+ * @param benchmark Name of the benchmark.
+ * @param name Name of the case.
+ * @param n Size measured.
+ * @param ops Number of operations timed.
+ * @param elapsed Nanoseconds they took.
+ * @param allocations Heap allocations they made.
+ */
+void Bench_report(const char* benchmark, const char* name, long n, long ops,
+                  double elapsed, long long allocations) {
+  double perOp = elapsed / (double)ops;
+  double allocsPerOp = (double)allocations / (double)ops;
+  printf("%-12s %-10s %10ld %12ld %10.2f %13.6f\n", benchmark, name, n, ops,
+         perOp, allocsPerOp);
+  fflush(stdout);
+  if (benchResults != NULL) {
+    fprintf(benchResults, "%s,%s,%ld,%ld,%.3f,%.6f\n", benchmark, name, n,
+            ops, perOp, allocsPerOp);
+    fflush(benchResults);
+  }
+}
+
+#endif /* _BENCH_H_ */
@@ -0,0 +1,118 @@
+/**
+ * @file buddy_bench.c
+ * @brief Measures the buddy allocator holding n blocks of random sizes.
+ *
+ * Every round fills the pool with n blocks, churns it by releasing a random
+ * block and allocating a new one n times, and drains it again. The sizes are
+ * log-uniform from 1 to 2047 bytes, so the slabs, the small buddy orders and
+ * the splits and merges between them all take their share of the requests.
+ * A churn operation is one release followed by one allocation.
+ */
+
+#include "bench.h"
+
+#include "../headers.h"
+
+/******************** MACROS ********************/
+#define __MIN_OPS__ 1000000L  /**< Lower bound on measured operations */
+#define __MAX_SIZE_ORDER__ 11 /**< Sizes are below 2^__MAX_SIZE_ORDER__ */
+#define __MIN_BLOCK__ 64      /**< Minimum block of the pool */
+/************************************************/
+
+/*************** Global Variables ***************/
+static unsigned long long state = __BENCH_SEED__;  // NOLINT
+/************************************************/
+
+/**
+ * @brief Draws a log-uniform size from 1 to 2^__MAX_SIZE_ORDER__ - 1.
+ *
+ * @return The size in bytes.
+ */
+size_t randomSize(void) {
+  size_t octave = (size_t)1 << (Bench_random(&state) % __MAX_SIZE_ORDER__);
+  return octave + Bench_random(&state) % octave;
+}
+
+/**
+ * @brief Allocates a block, exiting if the pool is exhausted.
+ *
+ * @param size The size of the block.
+ * @return Pointer to the block.
+ */
+void* allocateOrExit(size_t size) {
+  void* block = allocate(size);
+  if (block == NULL) {
+    fprintf(stderr, "The pool of %zu bytes is exhausted\n",
+            globalAllocator.totalSize);
+    exit(-1);
+  }
+  return block;
+}
+
+/**
+ * @brief Fills the pool with n blocks, churns it and drains it.
+ *
+ * @param blocks Array of n pointers, set to the live blocks.
+ * @param n Number of live blocks.
+ * @param elapsed Accumulates the time taken by the fill, churn and drain.
+ * @param allocations Accumulates the heap allocations they made.
+ */
+void fillChurnDrain(void** blocks, long n, double elapsed[3],
+                    long long allocations[3]) {
+  long long before = benchAllocations;
+  double start = nowNs();
+  for (long i = 0; i < n; i++) {
+    blocks[i] = allocateOrExit(randomSize());
+  }
+  double filled = nowNs();
+  long long afterFill = benchAllocations;
+  for (long i = 0; i < n; i++) {
+    long victim = (long)(Bench_random(&state) % (unsigned long long)n);
+    deallocate(blocks[victim]);
+    blocks[victim] = allocateOrExit(randomSize());
+  }
+  double churned = nowNs();
+  long long afterChurn = benchAllocations;
+  for (long i = 0; i < n; i++) {
+    deallocate(blocks[i]);
+  }
+  elapsed[0] += filled - start;
+  elapsed[1] += churned - filled;
+  elapsed[2] += nowNs() - churned;
+  allocations[0] += afterFill - before;
+  allocations[1] += afterChurn - afterFill;
+  allocations[2] += benchAllocations - afterChurn;
+}
+
+int main(int argc, char* argv[]) {
+  Bench_Init(argc, argv);
+  static const char* const names[3] = {"fill", "churn", "drain"};
+  for (long n = __BENCH_MIN__; n <= benchMax; n *= 10) {
+    /* Twice the worst case of n blocks of the largest order */
+    initializeBuddyAllocator((size_t)n << (__MAX_SIZE_ORDER__ + 1),
+                             __MIN_BLOCK__);
+    void** blocks = (void**)malloc(n * sizeof(void*));
+    if (blocks == NULL) {
+      perror("Error in allocating the blocks");
+      exit(-1);
+    }
+    /* Enough rounds to time at least __MIN_OPS__ operations of each phase */
+    long rounds = n < __MIN_OPS__ ? __MIN_OPS__ / n : 1;
+    double elapsed[3] = {0, 0, 0};
+    long long allocations[3] = {0, 0, 0};
+    /* One untimed round so the bookkeeping is grown, as in a long run */
+    fillChurnDrain(blocks, n, elapsed, allocations);
+    memset(elapsed, 0, sizeof(elapsed));
+    memset(allocations, 0, sizeof(allocations));
+    for (long r = 0; r < rounds; r++) {
+      fillChurnDrain(blocks, n, elapsed, allocations);
+    }
+    for (int phase = 0; phase < 3; phase++) {
+      Bench_report("buddy", names[phase], n, n * rounds, elapsed[phase],
+                   allocations[phase]);
+    }
+    free(blocks);
+    destroyBuddyAllocator();
+  }
+  return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file circ_queue_bench.c
+ * @brief Compares the ring-buffer Circ_Queue against the linked-node queue it
+ * replaced, under the rotation pattern Round Robin produces.
+ */
+
+#include "bench.h"
+
+#include "../headers.h"
+
+/******************** MACROS ********************/
+#define __MIN_ROTATIONS__ 10000000L /**< Lower bound on measured rotations */
+/************************************************/
+
+/**
+ * @brief Node of the linked circular queue (previous implementation).
+ */
+typedef struct Linked_Node {
+  struct PCB process;       /**< Process Control Block */
+  struct Linked_Node* next; /**< Pointer to the next node */
+} Linked_Node;
+
+/**
+ * @brief Linked circular queue (previous implementation).
+ */
+typedef struct Linked_Queue {
+  struct Linked_Node* head; /**< Pointer to the head of the queue */
+  struct Linked_Node* tail; /**< Pointer to the tail of the queue */
+} Linked_Queue;
+
+/**
+ * @brief Enqueues a process into the linked queue, allocating a node.
+ */
+void Linked_Queue_enqueue(Linked_Queue* q, PCB process) {
+  struct Linked_Node* newNode = (Linked_Node*)malloc(sizeof(Linked_Node));
+  newNode->process = process;
+  if (q->head == NULL) {
+    q->head = newNode;
+    q->tail = newNode;
+    newNode->next = newNode;
+  } else {
+    newNode->next = q->head;
+    q->tail->next = newNode;
+    q->tail = newNode;
+  }
+}
+
+/**
+ * @brief Dequeues the head of a non-empty linked queue, freeing its node.
+ */
+PCB Linked_Queue_dequeue(Linked_Queue* q) {
+  struct Linked_Node* temp = q->head;
+  struct PCB process = temp->process;
+  if (q->head == q->tail) {
+    q->head = NULL;
+    q->tail = NULL;
+  } else {
+    q->head = q->head->next;
+    q->tail->next = q->head;
+  }
+  free(temp);
+  return process;
+}
+
+/**
+ * @brief Builds a PCB with the given id and remaining time.
+ */
+PCB makePCB(int id) {
+  PCB pcb;
+  memset(&pcb, 0, sizeof(pcb));
+  pcb.id = id;
+  pcb.remainingTime = id % 30 + 1;
+  return pcb;
+}
+
+/**
+ * @brief Fills a ring queue with n entries and rotates it.
+ *
+ * @return Nanoseconds taken by the rotations (one dequeue plus one enqueue
+ * each), whose heap allocations are added to allocations.
+ */
+double benchRing(int n, long rotations, long* checksum,
+                 long long* allocations) {
+  Circ_Queue q;
+  Circ_Queue_Init(&q);
+  for (int i = 0; i < n; i++) {
+    Circ_Queue_enqueue(&q, makePCB(i));
+  }
+  /* One untimed lap so the steady state is measured, not first touches */
+  for (int i = 0; i < n; i++) {
+    Circ_Queue_enqueue(&q, Circ_Queue_dequeue(&q));
+  }
+  long long before = benchAllocations;
+  double start = nowNs();
+  for (long r = 0; r < rotations; r++) {
+    PCB pcb = Circ_Queue_dequeue(&q);
+    pcb.remainingTime--;
+    *checksum += pcb.id;
+    Circ_Queue_enqueue(&q, pcb);
+  }
+  double elapsed = nowNs() - start;
+  *allocations += benchAllocations - before;
+  Circ_Queue_Destroy(&q);
+  return elapsed;
+}
+
+/**
+ * @brief Fills a linked queue with n entries and rotates it.
+ *
+ * @return Nanoseconds taken by the rotations (one dequeue plus one enqueue
+ * each), whose heap allocations are added to allocations.
+ */
+double benchLinked(int n, long rotations, long* checksum,
+                   long long* allocations) {
+  Linked_Queue q = {NULL, NULL};
+  for (int i = 0; i < n; i++) {
+    Linked_Queue_enqueue(&q, makePCB(i));
+  }
+  /* One untimed lap so the steady state is measured, not first touches */
+  for (int i = 0; i < n; i++) {
+    Linked_Queue_enqueue(&q, Linked_Queue_dequeue(&q));
+  }
+  long long before = benchAllocations;
+  double start = nowNs();
+  for (long r = 0; r < rotations; r++) {
+    PCB pcb = Linked_Queue_dequeue(&q);
+    pcb.remainingTime--;
+    *checksum += pcb.id;
+    Linked_Queue_enqueue(&q, pcb);
+  }
+  double elapsed = nowNs() - start;
+  *allocations += benchAllocations - before;
+  while (q.head != NULL) {
+    Linked_Queue_dequeue(&q);
+  }
+  return elapsed;
+}
+
+int main(int argc, char* argv[]) {
+  Bench_Init(argc, argv);
+  long checksum = 0;
+  for (long n = __BENCH_MIN__; n <= benchMax; n *= 10) {
+    /* Rotate at least one full lap so every entry is touched */
+    long rotations = n > __MIN_ROTATIONS__ ? n : __MIN_ROTATIONS__;
+    long long allocations = 0;
+    double linked = benchLinked((int)n, rotations, &checksum, &allocations);
+    Bench_report("circ_queue", "linked", n, rotations, linked, allocations);
+    allocations = 0;
+    double ring = benchRing((int)n, rotations, &checksum, &allocations);
+    Bench_report("circ_queue", "ring", n, rotations, ring, allocations);
+  }
+  /* Keep the rotations observable so they are not optimized away */
+  printf("checksum %ld\n", checksum);
+  return 0;
+}
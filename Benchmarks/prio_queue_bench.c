@@ -0,0 +1,112 @@
+/**
+ * @file prio_queue_bench.c
+ * @brief Measures Prio_Queue filled with n processes and drained again, the
+ * pattern the HPF and SRTN ready queues follow.
+ *
+ * The keys are either random, as the priorities of a workload are, or
+ * ascending, as the remaining times of processes arriving in order of length
+ * are. Enqueues and dequeues are timed apart, since a dequeue sifts down the
+ * whole heap while an enqueue only sifts up.
+ */
+
+#include "bench.h"
+
+#include "../headers.h"
+
+/******************** MACROS ********************/
+#define __MIN_OPS__ 10000000L /**< Lower bound on measured operations */
+/************************************************/
+
+/**
+ * @brief Fills a queue with the processes 0 to n - 1 and drains it.
+ *
+ * @param q Pointer to the empty queue.
+ * @param keys Priority of every process.
+ * @param n Number of processes.
+ * @param checksum Accumulates the dequeued ids.
+ * @param enqueueNs Accumulates the time taken by the enqueues.
+ * @param dequeueNs Accumulates the time taken by the dequeues.
+ * @param enqueueAllocs Accumulates the allocations made by the enqueues.
+ * @param dequeueAllocs Accumulates the allocations made by the dequeues.
+ */
+void fillAndDrain(Prio_Queue* q, const int* keys, long n, long* checksum,
+                  double* enqueueNs, double* dequeueNs,
+                  long long* enqueueAllocs, long long* dequeueAllocs) {
+  PCB pcb;
+  memset(&pcb, 0, sizeof(pcb));
+  long long before = benchAllocations;
+  double start = nowNs();
+  for (long i = 0; i < n; i++) {
+    pcb.id = (int)i;
+    pcb.prio = keys[i];
+    Prio_Queue_enqueue(q, keys[i], pcb);
+  }
+  double middle = nowNs();
+  long long between = benchAllocations;
+  while (!Prio_Queue_isEmpty(q)) {
+    *checksum += Prio_Queue_dequeue(q).id;
+  }
+  *dequeueNs += nowNs() - middle;
+  *enqueueNs += middle - start;
+  *dequeueAllocs += benchAllocations - between;
+  *enqueueAllocs += between - before;
+}
+
+/**
+ * @brief Measures a queue of n processes with the given keys.
+ *
+ * @param name Name of the key order.
+ * @param keys Priority of every process.
+ * @param n Number of processes.
+ * @param checksum Accumulates the dequeued ids.
+ */
+void benchKeys(const char* name, const int* keys, long n, long* checksum) {
+  /* Enough rounds to time at least __MIN_OPS__ operations of each kind */
+  long rounds = n < __MIN_OPS__ ? __MIN_OPS__ / n : 1;
+  Prio_Queue q;
+  Prio_Queue_Init(&q);
+  double enqueueNs = 0;
+  double dequeueNs = 0;
+  long long enqueueAllocs = 0;
+  long long dequeueAllocs = 0;
+  /* One untimed round so the arrays are grown, as in a running scheduler */
+  fillAndDrain(&q, keys, n, checksum, &enqueueNs, &dequeueNs, &enqueueAllocs,
+               &dequeueAllocs);
+  enqueueNs = dequeueNs = 0;
+  enqueueAllocs = dequeueAllocs = 0;
+  for (long r = 0; r < rounds; r++) {
+    fillAndDrain(&q, keys, n, checksum, &enqueueNs, &dequeueNs,
+                 &enqueueAllocs, &dequeueAllocs);
+  }
+  Prio_Queue_Destroy(&q);
+  char label[32];
+  snprintf(label, sizeof(label), "%s-enq", name);
+  Bench_report("prio_queue", label, n, n * rounds, enqueueNs, enqueueAllocs);
+  snprintf(label, sizeof(label), "%s-deq", name);
+  Bench_report("prio_queue", label, n, n * rounds, dequeueNs, dequeueAllocs);
+}
+
+int main(int argc, char* argv[]) {
+  Bench_Init(argc, argv);
+  long checksum = 0;
+  unsigned long long state = __BENCH_SEED__;
+  for (long n = __BENCH_MIN__; n <= benchMax; n *= 10) {
+    int* keys = (int*)malloc(n * sizeof(int));
+    if (keys == NULL) {
+      perror("Error in allocating the keys");
+      exit(-1);
+    }
+    for (long i = 0; i < n; i++) {
+      keys[i] = (int)(Bench_random(&state) % (unsigned long long)n);
+    }
+    benchKeys("random", keys, n, &checksum);
+    for (long i = 0; i < n; i++) {
+      keys[i] = (int)i;
+    }
+    benchKeys("sorted", keys, n, &checksum);
+    free(keys);
+  }
+  /* Keep the dequeues observable so they are not optimized away */
+  printf("checksum %ld\n", checksum);
+  return 0;
+}
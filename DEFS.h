@@ -10,7 +10,8 @@
 /**************** Global Macros *****************/
 #define __FILE_KEY_NAME__ "keyfile"
 #define __FILE_KEY_VAL__ 65
-#define __MSG_TYPE__ 10
+#define __STATS_KEY_VAL__ 83        /**< Key of the stats page */
+#define __RING_CAPACITY__ (1 << 16) /**< Slots of the arrivals ring */
 /************************************************/
 
 /**
@@ -36,19 +37,65 @@ typedef struct PCB {
   int runTime;       /**< Total runtime required by the process */
   int remainingTime; /**< Decrementer to get the remaining time */
   int waitTime;      /**< Total waited time from start to end of the run */
+  int readyTime;     /**< First time step counted as waiting in the queue */
   int endTime;       /**< Time at which the process finishes execution */
   int prio;          /**< Priority of the process */
   int memory;        /**< Memory required to allocate */
   enum ProcessState state; /**< Current state of the process */
   void* memPointer;        /**< Pointer to memory allocation */
+  int worker;              /**< Worker running the process, -1 if none */
+  int cpu;                 /**< CPU it last ran on, -1 if none */
+  int level;               /**< MLFQ level, 0 being the highest */
+  int slice;               /**< Time left of its quantum at that level */
+  long long vruntime;      /**< CFS virtual runtime, weighted by prio */
 } PCB;
 
 /**
- * @brief Struct representing a message buffer for IPC containing a PCB.
+ * @brief Struct representing a process as read from the processes file, which
+ * is all the generator sends to the scheduler.
  */
-typedef struct msgbuff {
-  long mtype;  /**< Message type */
-  PCB process; /**< Process Control Block */
-} msgbuff;
+typedef struct ProcessRecord {
+  int id;          /**< Unique identifier of the process */
+  int arrivalTime; /**< Time at which the process arrives */
+  int runTime;     /**< Total runtime required by the process */
+  int prio;        /**< Priority of the process */
+  int memory;      /**< Memory required to allocate */
+} ProcessRecord;
+
+/**
+ * @brief Struct heading the processes sent for one time step.
+ */
+typedef struct BatchHeader {
+  int tick;  /**< Time step the processes are sent at */
+  int count; /**< Number of processes following the header */
+} BatchHeader;
+
+/**
+ * @brief Enum defining the commands the scheduler gives to a worker.
+ */
+typedef enum WorkerCommand {
+  _WORKER_IDLE = 0,    /**< Wait for a process */
+  _WORKER_RUN = 1,     /**< Run the process in the slot */
+  _WORKER_RELEASE = 2, /**< The process finished, wait for the next one */
+  _WORKER_EXIT = 3     /**< Exit */
+} WorkerCommand;
+
+/**
+ * @brief Struct shared by the scheduler and a pooled process.out, which is
+ * the control channel of the worker.
+ *
+ * While it runs a process, the worker publishes the remaining time of the
+ * process at every time step, computed from the time the process last got
+ * the CPU, so the scheduler reads the progress instead of counting it.
+ */
+typedef struct WorkerSlot {
+  _Alignas(64) int seq; /**< Bumped on every command, the futex word */
+  int command;          /**< Latest WorkerCommand */
+  int id;               /**< Id of the process being run */
+  int base;             /**< Remaining time when it last got the CPU */
+  int since;            /**< Time step it last got the CPU at */
+  _Alignas(64) int clk; /**< Last time step published by the worker */
+  int remaining;        /**< Remaining time at that time step */
+} WorkerSlot;
 
 #endif /* _DEFS_H_ */
\ No newline at end of file
@@ -1,24 +1,21 @@
 /**
  * @file CircQueue.h
  * @brief Header file for Circular Queue.
+ *
+ * The queue is a growable ring buffer whose capacity is kept a power of two,
+ * so rotating a process from the head to the tail never allocates.
  */
 #ifndef _CIRC_QUEUE_H_
 #define _CIRC_QUEUE_H_
 
-/**
- * @brief Structure representing a node in the circular queue.
- */
-typedef struct Circ_Node {
-  struct PCB process;     /**< Process Control Block */
-  struct Circ_Node* next; /**< Pointer to the next node */
-} Circ_Node;
-
 /**
  * @brief Structure representing a circular queue.
  */
 typedef struct Circ_Queue {
-  struct Circ_Node* head; /**< Pointer to the head of the queue */
-  struct Circ_Node* tail; /**< Pointer to the tail of the queue */
+  struct PCB* buffer; /**< Ring of queued processes */
+  int head;           /**< Index of the head in the ring */
+  int size;           /**< Number of queued processes */
+  int capacity;       /**< Length of the ring, always a power of two */
 } Circ_Queue;
 
 /**
@@ -27,8 +24,50 @@ typedef struct Circ_Queue {
  * @param q Pointer to the circular queue to be initialized.
  */
 void Circ_Queue_Init(Circ_Queue* q) {
-  q->head = NULL;
-  q->tail = NULL;
+  q->buffer = NULL;
+  q->head = 0;
+  q->size = 0;
+  q->capacity = 0;
+}
+
+/**
+ * @brief Releases the memory held by the circular queue.
+ *
+ * @param q Pointer to the circular queue.
+ */
+void Circ_Queue_Destroy(Circ_Queue* q) {
+  free(q->buffer);
+  Circ_Queue_Init(q);
+}
+
+/**
+ * @brief Doubles the capacity of the ring, unwrapping it at index 0.
+ *
+ * @param q Pointer to the circular queue.
+ * @return true on success, false if the allocation failed.
+ */
+bool Circ_Queue_grow(Circ_Queue* q) {
+  int newCapacity = q->capacity == 0 ? 16 : q->capacity * 2;
+  struct PCB* newBuffer =
+      (struct PCB*)malloc(newCapacity * sizeof(struct PCB));  // NOLINT
+  if (newBuffer == NULL) {
+    return false;
+  }
+  // Copy the two contiguous runs of the old ring in order
+  int first = q->capacity - q->head;
+  if (first > q->size) {
+    first = q->size;
+  }
+  if (q->size > 0) {
+    memcpy(newBuffer, q->buffer + q->head, first * sizeof(struct PCB));
+    memcpy(newBuffer + first, q->buffer,
+           (q->size - first) * sizeof(struct PCB));
+  }
+  free(q->buffer);
+  q->buffer = newBuffer;
+  q->head = 0;
+  q->capacity = newCapacity;
+  return true;
 }
 
 /**
@@ -38,24 +77,12 @@ void Circ_Queue_Init(Circ_Queue* q) {
  * @param process Process Control Block (PCB) to be enqueued.
  */
 void Circ_Queue_enqueue(Circ_Queue* q, PCB process) {
-  // Create new node
-  struct Circ_Node* newNode = (Circ_Node*)malloc(sizeof(Circ_Node));
-  if (newNode == NULL) {
+  if (q->size == q->capacity && !Circ_Queue_grow(q)) {
     fprintf(stderr, "Memory allocation failed.\n");
     return;
   }
-  newNode->process = process;
-  newNode->next = NULL;
-  // case queue is empty
-  if (q->head == NULL) {
-    q->head = newNode;
-    q->tail = newNode;
-    newNode->next = newNode;
-  } else {
-    newNode->next = q->head;
-    q->tail->next = newNode;
-    q->tail = newNode;
-  }
+  q->buffer[(q->head + q->size) & (q->capacity - 1)] = process;
+  q->size++;
 }
 
 /**
@@ -68,20 +95,12 @@ PCB Circ_Queue_dequeue(Circ_Queue* q) {
   struct PCB emptyPCB;
   emptyPCB.id = -1;
   // Check if the queue is empty
-  if (q->head == NULL) {
+  if (q->size == 0) {
     return emptyPCB;
   }
-  // Remove the node from the head of the queue
-  struct Circ_Node* temp = q->head;
-  emptyPCB = temp->process;
-  if (q->head == q->tail) {
-    q->head = NULL;
-    q->tail = NULL;
-  } else {
-    q->head = q->head->next;
-    q->tail->next = q->head;
-  }
-  free(temp);
+  emptyPCB = q->buffer[q->head];
+  q->head = (q->head + 1) & (q->capacity - 1);
+  q->size--;
   return emptyPCB;
 }
 
@@ -91,28 +110,6 @@ PCB Circ_Queue_dequeue(Circ_Queue* q) {
  * @param q Pointer to the circular queue.
  * @return true if the circular queue is empty, false otherwise.
  */
-bool Circ_Queue_isEmpty(Circ_Queue* q) { return (bool)(q->head == NULL); }
-
-/**
- * @brief Increments the waiting time of all process in the circular queue.
- *
- * @param q Pointer to the circular queue.
- * @param time Current time.
- */
-void Circ_Queue_Inc_WaitingTime(Circ_Queue* q, int time) {
-  if (q->head == NULL) {
-    return;
-  }
-  struct Circ_Node* current = q->head;
-  while (current != q->tail) {
-    if (current->process.arrivalTime < time) {
-      current->process.waitTime++;
-    }
-    current = current->next;
-  }
-  if (current->process.arrivalTime < time) {
-    current->process.waitTime++;
-  }
-}
+bool Circ_Queue_isEmpty(Circ_Queue* q) { return (bool)(q->size == 0); }
 
 #endif /* _CIRC_QUEUE_H_ */
\ No newline at end of file
@@ -0,0 +1,415 @@
+/**
+ * @file FairTree.h
+ * @brief Header file for Fair Tree.
+ *
+ * The ready queue of the completely fair policy: a red-black tree of
+ * processes ordered by virtual runtime, with the leftmost node cached so the
+ * next process is found in constant time. Processes with equal virtual
+ * runtimes leave the tree in the order they entered it.
+ *
+ * Nodes live in a pool that grows geometrically and links the free nodes
+ * together, so inserting and removing never allocate once the pool is large
+ * enough. Nodes refer to each other by index, which stays valid when the pool
+ * moves, and node 0 is the black leaf shared by the whole tree.
+ */
+#ifndef _FAIR_TREE_H_
+#define _FAIR_TREE_H_
+
+/**
+ * @brief Structure representing a node in the fair tree.
+ */
+typedef struct Fair_Node {
+  long long key;       /**< Virtual runtime of the process */
+  unsigned long order; /**< Insertion stamp used for FIFO tie-breaking */
+  int left;            /**< Index of the left child, 0 if none */
+  int right;           /**< Index of the right child, or the next free node */
+  int parent;          /**< Index of the parent, 0 for the root */
+  bool red;            /**< Color of the node */
+  struct PCB process;  /**< Process Control Block */
+} Fair_Node;
+
+/**
+ * @brief Structure representing a fair tree.
+ */
+typedef struct Fair_Tree {
+  struct Fair_Node* nodes; /**< Pool of nodes, node 0 being the leaf */
+  int capacity;            /**< Allocated length of the pool */
+  int root;                /**< Index of the root, 0 if empty */
+  int leftmost;            /**< Index of the smallest node, 0 if empty */
+  int freeList;            /**< Index of the first free node, 0 if none */
+  int size;                /**< Number of queued processes */
+  unsigned long order;     /**< Next insertion stamp */
+} Fair_Tree;
+
+/**
+ * @brief Initializes a fair tree.
+ *
+ * @param t Pointer to the fair tree to be initialized.
+ */
+void Fair_Tree_Init(Fair_Tree* t) {
+  t->nodes = NULL;
+  t->capacity = 0;
+  t->root = 0;
+  t->leftmost = 0;
+  t->freeList = 0;
+  t->size = 0;
+  t->order = 0;
+}
+
+/**
+ * @brief Releases the memory held by the fair tree.
+ *
+ * @param t Pointer to the fair tree.
+ */
+void Fair_Tree_Destroy(Fair_Tree* t) {
+  free(t->nodes);
+  Fair_Tree_Init(t);
+}
+
+/**
+ * @brief Doubles the pool and links the new nodes into the free list.
+ *
+ * @param t Pointer to the fair tree.
+ * @return true on success, false if the allocation failed.
+ */
+bool Fair_Tree_grow(Fair_Tree* t) {
+  int newCapacity = t->capacity == 0 ? 16 : t->capacity * 2;
+  Fair_Node* newNodes = (Fair_Node*)realloc(
+      t->nodes, newCapacity * sizeof(Fair_Node));  // NOLINT
+  if (newNodes == NULL) {
+    return false;
+  }
+  int first = t->capacity;
+  if (first == 0) {
+    /* The shared leaf */
+    newNodes[0].left = newNodes[0].right = newNodes[0].parent = 0;
+    newNodes[0].red = false;
+    first = 1;
+  }
+  for (int i = newCapacity - 1; i >= first; i--) {
+    newNodes[i].right = t->freeList;
+    t->freeList = i;
+  }
+  t->nodes = newNodes;
+  t->capacity = newCapacity;
+  return true;
+}
+
+/**
+ * @brief Checks whether node a has to leave the tree before node b.
+ */
+bool Fair_Node_before(const Fair_Node* a, const Fair_Node* b) {
+  return a->key < b->key || (a->key == b->key && a->order < b->order);
+}
+
+/**
+ * @brief Rotates the subtree at x to the left.
+ */
+void Fair_Tree_rotateLeft(Fair_Tree* t, int x) {
+  Fair_Node* n = t->nodes;
+  int y = n[x].right;
+  n[x].right = n[y].left;
+  if (n[y].left != 0) {
+    n[n[y].left].parent = x;
+  }
+  n[y].parent = n[x].parent;
+  if (n[x].parent == 0) {
+    t->root = y;
+  } else if (x == n[n[x].parent].left) {
+    n[n[x].parent].left = y;
+  } else {
+    n[n[x].parent].right = y;
+  }
+  n[y].left = x;
+  n[x].parent = y;
+}
+
+/**
+ * @brief Rotates the subtree at x to the right.
+ */
+void Fair_Tree_rotateRight(Fair_Tree* t, int x) {
+  Fair_Node* n = t->nodes;
+  int y = n[x].left;
+  n[x].left = n[y].right;
+  if (n[y].right != 0) {
+    n[n[y].right].parent = x;
+  }
+  n[y].parent = n[x].parent;
+  if (n[x].parent == 0) {
+    t->root = y;
+  } else if (x == n[n[x].parent].right) {
+    n[n[x].parent].right = y;
+  } else {
+    n[n[x].parent].left = y;
+  }
+  n[y].right = x;
+  n[x].parent = y;
+}
+
+/**
+ * @brief Restores the red-black properties after node z was inserted.
+ */
+void Fair_Tree_insertFixup(Fair_Tree* t, int z) {
+  Fair_Node* n = t->nodes;
+  while (n[n[z].parent].red) {
+    int p = n[z].parent;
+    int g = n[p].parent;
+    if (p == n[g].left) {
+      int uncle = n[g].right;
+      if (n[uncle].red) {
+        n[p].red = false;
+        n[uncle].red = false;
+        n[g].red = true;
+        z = g;
+        continue;
+      }
+      if (z == n[p].right) {
+        z = p;
+        Fair_Tree_rotateLeft(t, z);
+        p = n[z].parent;
+      }
+      n[p].red = false;
+      n[g].red = true;
+      Fair_Tree_rotateRight(t, g);
+    } else {
+      int uncle = n[g].left;
+      if (n[uncle].red) {
+        n[p].red = false;
+        n[uncle].red = false;
+        n[g].red = true;
+        z = g;
+        continue;
+      }
+      if (z == n[p].left) {
+        z = p;
+        Fair_Tree_rotateRight(t, z);
+        p = n[z].parent;
+      }
+      n[p].red = false;
+      n[g].red = true;
+      Fair_Tree_rotateLeft(t, g);
+    }
+  }
+  n[t->root].red = false;
+}
+
+/**
+ * @brief Inserts a process into the fair tree.
+ *
+ * @param t Pointer to the fair tree.
+ * @param key Virtual runtime of the process.
+ * @param process Process Control Block (PCB) to be inserted.
+ * @return true on success, false if the allocation failed.
+ */
+bool Fair_Tree_insert(Fair_Tree* t, long long key, PCB process) {
+  if (t->freeList == 0 && !Fair_Tree_grow(t)) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    return false;
+  }
+  Fair_Node* n = t->nodes;
+  int z = t->freeList;
+  t->freeList = n[z].right;
+  n[z].key = key;
+  n[z].order = t->order++;
+  n[z].left = 0;
+  n[z].right = 0;
+  n[z].red = true;
+  n[z].process = process;
+  int parent = 0;
+  int x = t->root;
+  bool leftmost = true;
+  while (x != 0) {
+    parent = x;
+    if (Fair_Node_before(&n[z], &n[x])) {
+      x = n[x].left;
+    } else {
+      x = n[x].right;
+      leftmost = false;
+    }
+  }
+  n[z].parent = parent;
+  if (parent == 0) {
+    t->root = z;
+  } else if (Fair_Node_before(&n[z], &n[parent])) {
+    n[parent].left = z;
+  } else {
+    n[parent].right = z;
+  }
+  if (leftmost) {
+    t->leftmost = z;
+  }
+  Fair_Tree_insertFixup(t, z);
+  t->size++;
+  return true;
+}
+
+/**
+ * @brief Replaces the subtree at u by the subtree at v.
+ */
+void Fair_Tree_transplant(Fair_Tree* t, int u, int v) {
+  Fair_Node* n = t->nodes;
+  if (n[u].parent == 0) {
+    t->root = v;
+  } else if (u == n[n[u].parent].left) {
+    n[n[u].parent].left = v;
+  } else {
+    n[n[u].parent].right = v;
+  }
+  n[v].parent = n[u].parent;
+}
+
+/**
+ * @brief Restores the red-black properties after a black node was removed
+ * above node x.
+ */
+void Fair_Tree_removeFixup(Fair_Tree* t, int x) {
+  Fair_Node* n = t->nodes;
+  while (x != t->root && !n[x].red) {
+    int p = n[x].parent;
+    if (x == n[p].left) {
+      int w = n[p].right;
+      if (n[w].red) {
+        n[w].red = false;
+        n[p].red = true;
+        Fair_Tree_rotateLeft(t, p);
+        w = n[p].right;
+      }
+      if (!n[n[w].left].red && !n[n[w].right].red) {
+        n[w].red = true;
+        x = p;
+        continue;
+      }
+      if (!n[n[w].right].red) {
+        n[n[w].left].red = false;
+        n[w].red = true;
+        Fair_Tree_rotateRight(t, w);
+        w = n[p].right;
+      }
+      n[w].red = n[p].red;
+      n[p].red = false;
+      n[n[w].right].red = false;
+      Fair_Tree_rotateLeft(t, p);
+    } else {
+      int w = n[p].left;
+      if (n[w].red) {
+        n[w].red = false;
+        n[p].red = true;
+        Fair_Tree_rotateRight(t, p);
+        w = n[p].left;
+      }
+      if (!n[n[w].left].red && !n[n[w].right].red) {
+        n[w].red = true;
+        x = p;
+        continue;
+      }
+      if (!n[n[w].left].red) {
+        n[n[w].right].red = false;
+        n[w].red = true;
+        Fair_Tree_rotateLeft(t, w);
+        w = n[p].left;
+      }
+      n[w].red = n[p].red;
+      n[p].red = false;
+      n[n[w].left].red = false;
+      Fair_Tree_rotateRight(t, p);
+    }
+    x = t->root;
+  }
+  n[x].red = false;
+}
+
+/**
+ * @brief Unlinks node z from the tree and returns it to the free list.
+ *
+ * @param t Pointer to the fair tree.
+ * @param z Index of the node.
+ */
+void Fair_Tree_removeNode(Fair_Tree* t, int z) {
+  Fair_Node* n = t->nodes;
+  int y = z;
+  bool removedRed = n[y].red;
+  int x;
+  if (n[z].left == 0) {
+    x = n[z].right;
+    Fair_Tree_transplant(t, z, n[z].right);
+  } else if (n[z].right == 0) {
+    x = n[z].left;
+    Fair_Tree_transplant(t, z, n[z].left);
+  } else {
+    /* Move in the successor of z, the smallest node of its right subtree */
+    y = n[z].right;
+    while (n[y].left != 0) {
+      y = n[y].left;
+    }
+    removedRed = n[y].red;
+    x = n[y].right;
+    if (n[y].parent == z) {
+      n[x].parent = y;
+    } else {
+      Fair_Tree_transplant(t, y, n[y].right);
+      n[y].right = n[z].right;
+      n[n[y].right].parent = y;
+    }
+    Fair_Tree_transplant(t, z, y);
+    n[y].left = n[z].left;
+    n[n[y].left].parent = y;
+    n[y].red = n[z].red;
+  }
+  if (!removedRed) {
+    Fair_Tree_removeFixup(t, x);
+  }
+  n[0].parent = 0;
+  n[z].right = t->freeList;
+  t->freeList = z;
+  t->size--;
+}
+
+/**
+ * @brief Returns the node with the smallest virtual runtime.
+ *
+ * @param t Pointer to the fair tree.
+ * @return Pointer to the node, or NULL if the tree is empty. The pointer is
+ * invalidated by the next modification of the tree.
+ */
+Fair_Node* Fair_Tree_peek(Fair_Tree* t) {
+  return t->size == 0 ? NULL : &t->nodes[t->leftmost];
+}
+
+/**
+ * @brief Takes the process with the smallest virtual runtime out of the tree.
+ *
+ * @param t Pointer to the fair tree.
+ * @return PCB of the process, with id = -1 if the tree is empty.
+ */
+PCB Fair_Tree_dequeue(Fair_Tree* t) {
+  struct PCB emptyPCB;
+  emptyPCB.id = -1;
+  if (t->size == 0) {
+    return emptyPCB;
+  }
+  Fair_Node* n = t->nodes;
+  int z = t->leftmost;
+  /* The leftmost node has no left child, so its successor is the smallest
+   * node of its right subtree, or its parent */
+  int next = n[z].parent;
+  if (n[z].right != 0) {
+    next = n[z].right;
+    while (n[next].left != 0) {
+      next = n[next].left;
+    }
+  }
+  PCB process = n[z].process;
+  Fair_Tree_removeNode(t, z);
+  t->leftmost = next;
+  return process;
+}
+
+/**
+ * @brief Checks if the fair tree is empty.
+ *
+ * @param t Pointer to the fair tree.
+ * @return true if no process is queued, false otherwise.
+ */
+bool Fair_Tree_isEmpty(Fair_Tree* t) { return (bool)(t->size == 0); }
+
+#endif /* _FAIR_TREE_H_ */
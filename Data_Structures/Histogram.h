@@ -0,0 +1,116 @@
+/**
+ * @file Histogram.h
+ * @brief Header file for Log-Linear Histogram.
+ *
+ * Counts non-negative values in the buckets of an HDR histogram: values
+ * below 2^HISTOGRAM_BITS each have their own bucket, and every power of two
+ * above is split into 2^(HISTOGRAM_BITS - 1) buckets of equal width. A value
+ * is thus located by a count-leading-zeros and a shift, the memory used is
+ * the same however many values are recorded, and the percentiles are off by
+ * less than 2^(1 - HISTOGRAM_BITS) of the value.
+ */
+#ifndef _HISTOGRAM_H_
+#define _HISTOGRAM_H_
+
+#define HISTOGRAM_BITS 8                           /**< Precision bits */
+#define HISTOGRAM_HALF (1 << (HISTOGRAM_BITS - 1)) /**< Buckets per octave */
+#define HISTOGRAM_BUCKETS ((66 - HISTOGRAM_BITS) * HISTOGRAM_HALF)
+
+/**
+ * @brief Structure representing a histogram.
+ */
+typedef struct Histogram {
+  long long counts[HISTOGRAM_BUCKETS]; /**< Values counted in every bucket */
+  long long total;                     /**< Number of values */
+  long long sum;                       /**< Sum of the values */
+  long long max;                       /**< Largest value */
+} Histogram;
+
+/**
+ * @brief Initializes an empty histogram.
+ *
+ * @param h Pointer to the histogram to be initialized.
+ */
+void Histogram_Init(Histogram* h) {
+  memset(h->counts, 0, sizeof(h->counts));
+  h->total = 0;
+  h->sum = 0;
+  h->max = 0;
+}
+
+/**
+ * @brief Returns the bucket of a value.
+ *
+ * @param value The value.
+ * @return The index of its bucket.
+ */
+int Histogram_bucket(unsigned long long value) {
+  if (value < 2 * HISTOGRAM_HALF) {
+    return (int)value;
+  }
+  int shift = (63 - __builtin_clzll(value)) - (HISTOGRAM_BITS - 1);
+  return shift * HISTOGRAM_HALF + (int)(value >> shift);
+}
+
+/**
+ * @brief Returns the largest value of a bucket.
+ *
+ * @param bucket The index of the bucket.
+ * @return The largest value counted in it.
+ */
+unsigned long long Histogram_highest(int bucket) {
+  if (bucket < 2 * HISTOGRAM_HALF) {
+    return (unsigned long long)bucket;
+  }
+  int shift = bucket / HISTOGRAM_HALF - 1;
+  unsigned long long top = bucket - shift * HISTOGRAM_HALF;
+  return ((top + 1) << shift) - 1;
+}
+
+/**
+ * @brief Counts a value; negative values are counted as 0.
+ *
+ * @param h Pointer to the histogram.
+ * @param value The value.
+ */
+void Histogram_record(Histogram* h, long long value) {
+  if (value < 0) {
+    value = 0;
+  }
+  h->counts[Histogram_bucket((unsigned long long)value)]++;
+  h->total++;
+  h->sum += value;
+  if (value > h->max) {
+    h->max = value;
+  }
+}
+
+/**
+ * @brief Returns the value below or at which a percentage of the values are.
+ *
+ * @param h Pointer to the histogram.
+ * @param percent The percentage, from 0 to 100.
+ * @return The largest value of the bucket holding the percentile, never more
+ * than the largest value counted, or 0 if the histogram is empty.
+ */
+long long Histogram_percentile(Histogram* h, double percent) {
+  double exact = percent / 100.0 * (double)h->total;
+  long long rank = (long long)exact;
+  if ((double)rank < exact) {
+    rank++;
+  }
+  if (rank < 1) {
+    rank = 1;
+  }
+  long long seen = 0;
+  for (int b = 0; b < HISTOGRAM_BUCKETS && seen < h->total; b++) {
+    seen += h->counts[b];
+    if (seen >= rank) {
+      long long highest = (long long)Histogram_highest(b);
+      return highest < h->max ? highest : h->max;
+    }
+  }
+  return h->max;
+}
+
+#endif /* _HISTOGRAM_H_ */
@@ -0,0 +1,114 @@
+/**
+ * @file LevelQueue.h
+ * @brief Header file for Multi-Level Queue.
+ *
+ * The ready queue of a multi-level feedback queue: one circular queue per
+ * level, level 0 being the highest, and a bitmask of the non-empty levels, so
+ * the highest non-empty level is found with a single find-first-set instead
+ * of scanning the levels.
+ */
+#ifndef _LEVEL_QUEUE_H_
+#define _LEVEL_QUEUE_H_
+
+#define LEVEL_QUEUE_LEVELS 64 /**< Levels representable by the bitmask */
+
+/**
+ * @brief Structure representing a multi-level queue.
+ */
+typedef struct Level_Queue {
+  struct Circ_Queue levels[LEVEL_QUEUE_LEVELS]; /**< Queued processes */
+  unsigned long long nonEmpty; /**< Bit l set if level l is not empty */
+  int size;                    /**< Number of queued processes */
+} Level_Queue;
+
+/**
+ * @brief Initializes a multi-level queue.
+ *
+ * @param q Pointer to the multi-level queue to be initialized.
+ */
+void Level_Queue_Init(Level_Queue* q) {
+  for (int l = 0; l < LEVEL_QUEUE_LEVELS; l++) {
+    Circ_Queue_Init(&q->levels[l]);
+  }
+  q->nonEmpty = 0;
+  q->size = 0;
+}
+
+/**
+ * @brief Releases the memory held by the multi-level queue.
+ *
+ * @param q Pointer to the multi-level queue.
+ */
+void Level_Queue_Destroy(Level_Queue* q) {
+  for (int l = 0; l < LEVEL_QUEUE_LEVELS; l++) {
+    Circ_Queue_Destroy(&q->levels[l]);
+  }
+  Level_Queue_Init(q);
+}
+
+/**
+ * @brief Enqueues a process at the back of a level.
+ *
+ * @param q Pointer to the multi-level queue.
+ * @param level Level of the process.
+ * @param process Process Control Block (PCB) to be enqueued.
+ */
+void Level_Queue_enqueue(Level_Queue* q, int level, PCB process) {
+  Circ_Queue_enqueue(&q->levels[level], process);
+  q->nonEmpty |= 1ULL << level;
+  q->size++;
+}
+
+/**
+ * @brief Returns the highest non-empty level.
+ *
+ * @param q Pointer to the multi-level queue.
+ * @return The level, or -1 if the queue is empty.
+ */
+int Level_Queue_top(Level_Queue* q) {
+  return q->nonEmpty == 0 ? -1 : __builtin_ctzll(q->nonEmpty);
+}
+
+/**
+ * @brief Dequeues the head of a level.
+ *
+ * @param q Pointer to the multi-level queue.
+ * @param level The level.
+ * @return PCB of the dequeued process, with id = -1 if the level is empty.
+ */
+PCB Level_Queue_dequeueLevel(Level_Queue* q, int level) {
+  PCB process = Circ_Queue_dequeue(&q->levels[level]);
+  if (process.id != -1) {
+    q->size--;
+    if (Circ_Queue_isEmpty(&q->levels[level])) {
+      q->nonEmpty &= ~(1ULL << level);
+    }
+  }
+  return process;
+}
+
+/**
+ * @brief Dequeues the head of the highest non-empty level.
+ *
+ * @param q Pointer to the multi-level queue.
+ * @return PCB of the dequeued process, with id = -1 if the queue is empty.
+ */
+PCB Level_Queue_dequeue(Level_Queue* q) {
+  int level = Level_Queue_top(q);
+  if (level == -1) {
+    struct PCB emptyPCB;
+    emptyPCB.id = -1;
+    return emptyPCB;
+  }
+  return Level_Queue_dequeueLevel(q, level);
+}
+
+/**
+ * @brief Checks if the multi-level queue is empty.
+ *
+ * @param q Pointer to the multi-level queue.
+ * @return true if no process is queued, false otherwise.
+ */
+bool Level_Queue_isEmpty(Level_Queue* q) { return (bool)(q->size == 0); }
+
+#endif /* _LEVEL_QUEUE_H_ */
@@ -0,0 +1,118 @@
+/**
+ * @file MemQueue.h
+ * @brief Header file for Memory-Wait Queue.
+ *
+ * Processes that could not get their memory wait here, grouped by size class
+ * (the order of the smallest power of two holding their memory). Each class
+ * is a priority queue, and a bitmask of the non-empty classes lets the
+ * classes that can be served be found without scanning all of them.
+ */
+#ifndef _MEM_QUEUE_H_
+#define _MEM_QUEUE_H_
+
+#define MEM_QUEUE_CLASSES 64 /**< Size classes representable by a size_t */
+
+/**
+ * @brief Structure representing a memory-wait queue.
+ */
+typedef struct Mem_Queue {
+  struct Prio_Queue classes[MEM_QUEUE_CLASSES]; /**< Waiting processes */
+  unsigned long long nonEmpty; /**< Bit k set if class k is not empty */
+  int size;                    /**< Number of waiting processes */
+} Mem_Queue;
+
+/**
+ * @brief Initializes a memory-wait queue.
+ *
+ * @param q Pointer to the memory-wait queue to be initialized.
+ */
+void Mem_Queue_Init(Mem_Queue* q) {
+  for (int k = 0; k < MEM_QUEUE_CLASSES; k++) {
+    Prio_Queue_Init(&q->classes[k]);
+  }
+  q->nonEmpty = 0;
+  q->size = 0;
+}
+
+/**
+ * @brief Releases the memory held by the memory-wait queue.
+ *
+ * @param q Pointer to the memory-wait queue.
+ */
+void Mem_Queue_Destroy(Mem_Queue* q) {
+  for (int k = 0; k < MEM_QUEUE_CLASSES; k++) {
+    Prio_Queue_Destroy(&q->classes[k]);
+  }
+  Mem_Queue_Init(q);
+}
+
+/**
+ * @brief Returns the size class of a memory request.
+ *
+ * @param memory The requested memory.
+ * @return The order k such that 2^k is the smallest power of two >= memory.
+ */
+int Mem_Queue_class(int memory) {
+  if (memory <= 1) {
+    return 0;
+  }
+  return (int)(sizeof(unsigned int) * 8) -
+         __builtin_clz((unsigned int)memory - 1);
+}
+
+/**
+ * @brief Enqueues a process into the class of its memory request.
+ *
+ * @param q Pointer to the memory-wait queue.
+ * @param prio Priority of the process inside its class.
+ * @param process Process Control Block (PCB) to be enqueued.
+ */
+void Mem_Queue_enqueue(Mem_Queue* q, int prio, PCB process) {
+  int k = Mem_Queue_class(process.memory);
+  Prio_Queue_enqueue(&q->classes[k], prio, process);
+  q->nonEmpty |= 1ULL << k;
+  q->size++;
+}
+
+/**
+ * @brief Returns the smallest non-empty class at or above a given class.
+ *
+ * @param q Pointer to the memory-wait queue.
+ * @param from Smallest class to consider.
+ * @return The class, or -1 if all the classes from there on are empty.
+ */
+int Mem_Queue_nextClass(Mem_Queue* q, int from) {
+  if (from >= MEM_QUEUE_CLASSES) {
+    return -1;
+  }
+  unsigned long long classes = q->nonEmpty >> from;
+  return classes == 0 ? -1 : from + __builtin_ctzll(classes);
+}
+
+/**
+ * @brief Dequeues the highest priority process of a class.
+ *
+ * @param q Pointer to the memory-wait queue.
+ * @param k The class.
+ * @return PCB of the dequeued process, with id = -1 if the class is empty.
+ */
+PCB Mem_Queue_dequeue(Mem_Queue* q, int k) {
+  PCB process = Prio_Queue_dequeue(&q->classes[k]);
+  if (process.id != -1) {
+    q->size--;
+    if (Prio_Queue_isEmpty(&q->classes[k])) {
+      q->nonEmpty &= ~(1ULL << k);
+    }
+  }
+  return process;
+}
+
+/**
+ * @brief Checks if the memory-wait queue is empty.
+ *
+ * @param q Pointer to the memory-wait queue.
+ * @return true if no process is waiting, false otherwise.
+ */
+bool Mem_Queue_isEmpty(Mem_Queue* q) { return (bool)(q->size == 0); }
+
+#endif /* _MEM_QUEUE_H_ */
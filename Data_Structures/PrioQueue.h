@@ -1,6 +1,9 @@
 /**
  * @file PrioQueue.h
  * @brief Header file for Priority Queue.
+ *
+ * The queue is a contiguous binary min-heap. Processes with equal priorities
+ * leave the queue in the order they entered it.
  */
 #ifndef _PRIO_QUEUE_H_
 #define _PRIO_QUEUE_H_
@@ -9,17 +12,19 @@
  * @brief Structure representing a node in the priority queue.
  */
 typedef struct Prio_Node {
-  int prio;               /**< Priority of the process */
-  struct PCB process;     /**< Process Control Block */
-  struct Prio_Node* next; /**< Pointer to the next node */
+  int prio;            /**< Priority of the process */
+  unsigned long order; /**< Insertion stamp used for FIFO tie-breaking */
+  struct PCB process;  /**< Process Control Block */
 } Prio_Node;
 
 /**
  * @brief Structure representing a priority queue.
  */
 typedef struct Prio_Queue {
-  struct Prio_Node* head; /**< Pointer to the head of the queue */
-  struct Prio_Node* tail; /**< Pointer to the tail of the queue */
+  struct Prio_Node* heap; /**< Array holding the heap */
+  int size;               /**< Number of queued processes */
+  int capacity;           /**< Allocated length of the heap array */
+  unsigned long order;    /**< Next insertion stamp */
 } Prio_Queue;
 
 /**
@@ -28,50 +33,144 @@ typedef struct Prio_Queue {
  * @param q Pointer to the priority queue to be initialized.
  */
 void Prio_Queue_Init(Prio_Queue* q) {
-  q->head = NULL;
-  q->tail = NULL;
+  q->heap = NULL;
+  q->size = 0;
+  q->capacity = 0;
+  q->order = 0;
 }
 
 /**
- * @brief Enqueues a process into the priority queue based on its priority.
+ * @brief Releases the memory held by the priority queue.
  *
  * @param q Pointer to the priority queue.
- * @param prio Priority of the process to be enqueued.
- * @param process Process Control Block (PCB) to be enqueued.
  */
-void Prio_Queue_enqueue(Prio_Queue* q, int prio, PCB process) {
-  // Create new node
-  struct Prio_Node* newNode = (Prio_Node*)malloc(sizeof(Prio_Node));
-  if (newNode == NULL) {
-    fprintf(stderr, "Memory allocation failed.\n");
-    return;
+void Prio_Queue_Destroy(Prio_Queue* q) {
+  free(q->heap);
+  Prio_Queue_Init(q);
+}
+
+/**
+ * @brief Checks whether node a has to leave the queue before node b.
+ *
+ * @param a First node.
+ * @param b Second node.
+ * @return true if a orders before b, false otherwise.
+ */
+bool Prio_Node_before(const Prio_Node* a, const Prio_Node* b) {
+  if (a->prio != b->prio) {
+    return (bool)(a->prio < b->prio);
+  }
+  return (bool)(a->order < b->order);
+}
+
+/**
+ * @brief Moves a node from a hole towards the root until the heap is valid.
+ *
+ * @param q Pointer to the priority queue.
+ * @param i Index of the hole to start from.
+ * @param node Node to be placed.
+ */
+void Prio_Queue_siftUp(Prio_Queue* q, int i, const Prio_Node* node) {
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    if (!Prio_Node_before(node, &q->heap[parent])) {
+      break;
+    }
+    q->heap[i] = q->heap[parent];
+    i = parent;
   }
-  newNode->prio = prio;
-  newNode->process = process;
-  newNode->next = NULL;
-  // case queue is empty
-  if (q->head == NULL) {
-    q->head = newNode;
-    q->tail = newNode;
-  } else {
-    struct Prio_Node* current = q->head;
-    struct Prio_Node* prev = NULL;
-    // Traverse the queue to find the correct position based on priority
-    while (current != NULL && current->prio < prio) {
-      prev = current;
-      current = current->next;
+  q->heap[i] = *node;
+}
+
+/**
+ * @brief Moves a node from a hole towards the leaves until the heap is valid.
+ *
+ * @param q Pointer to the priority queue.
+ * @param i Index of the hole to start from.
+ * @param node Node to be placed.
+ */
+void Prio_Queue_siftDown(Prio_Queue* q, int i, const Prio_Node* node) {
+  while (true) {
+    int child = 2 * i + 1;
+    if (child >= q->size) {
+      break;
+    }
+    if (child + 1 < q->size &&
+        Prio_Node_before(&q->heap[child + 1], &q->heap[child])) {
+      child++;
     }
-    if (prev == NULL) {
-      newNode->next = q->head;
-      q->head = newNode;
-    } else {
-      prev->next = newNode;
-      newNode->next = current;
+    if (!Prio_Node_before(&q->heap[child], node)) {
+      break;
+    }
+    q->heap[i] = q->heap[child];
+    i = child;
+  }
+  q->heap[i] = *node;
+}
+
+/**
+ * @brief Appends a process at the end of the heap array without restoring the
+ * heap, which Prio_Queue_heapify must do before the queue is used again.
+ *
+ * @param q Pointer to the priority queue.
+ * @param prio Priority of the process to be appended.
+ * @param process Process Control Block (PCB) to be appended.
+ * @return true on success, false if the allocation failed.
+ */
+bool Prio_Queue_append(Prio_Queue* q, int prio, PCB process) {
+  // Grow the heap array geometrically
+  if (q->size == q->capacity) {
+    int newCapacity = q->capacity == 0 ? 16 : q->capacity * 2;
+    Prio_Node* newHeap = (Prio_Node*)realloc(
+        q->heap, newCapacity * sizeof(Prio_Node));  // NOLINT
+    if (newHeap == NULL) {
+      fprintf(stderr, "Memory allocation failed.\n");
+      return false;
     }
-    // Update tail if newNode is the last node
-    if (newNode->next == NULL) {
-      q->tail = newNode;
+    q->heap = newHeap;
+    q->capacity = newCapacity;
+  }
+  Prio_Node* node = &q->heap[q->size++];
+  node->prio = prio;
+  node->order = q->order++;
+  node->process = process;
+  return true;
+}
+
+/**
+ * @brief Restores the heap after processes were appended from a heap index.
+ *
+ * A few appended processes are sifted up one by one. When they outnumber the
+ * processes already queued, the whole heap is rebuilt bottom-up instead, in
+ * time linear in its size. Both give the same dequeue order.
+ *
+ * @param q Pointer to the priority queue.
+ * @param from Size of the queue before the processes were appended.
+ */
+void Prio_Queue_heapify(Prio_Queue* q, int from) {
+  if (q->size - from <= from) {
+    for (int i = from; i < q->size; i++) {
+      Prio_Node node = q->heap[i];
+      Prio_Queue_siftUp(q, i, &node);
     }
+    return;
+  }
+  for (int i = q->size / 2 - 1; i >= 0; i--) {
+    Prio_Node node = q->heap[i];
+    Prio_Queue_siftDown(q, i, &node);
+  }
+}
+
+/**
+ * @brief Enqueues a process into the priority queue based on its priority.
+ *
+ * @param q Pointer to the priority queue.
+ * @param prio Priority of the process to be enqueued.
+ * @param process Process Control Block (PCB) to be enqueued.
+ */
+void Prio_Queue_enqueue(Prio_Queue* q, int prio, PCB process) {
+  if (Prio_Queue_append(q, prio, process)) {
+    Prio_Queue_heapify(q, q->size - 1);
   }
 }
 
@@ -85,49 +184,35 @@ PCB Prio_Queue_dequeue(Prio_Queue* q) {
   struct PCB emptyPCB;
   emptyPCB.id = -1;
   // Check if the queue is empty
-  if (q->head == NULL) {
+  if (q->size == 0) {
     return emptyPCB;
   }
-
-  // Remove the node from the head of the queue
-  struct Prio_Node* temp = q->head;
-  emptyPCB = temp->process;
-  q->head = q->head->next;
-
-  // If the queue is now empty, update tail to NULL
-  free(temp);
-  if (q->head == NULL) {
-    q->tail = NULL;
+  PCB removed = q->heap[0].process;
+  q->size--;
+  if (q->size > 0) {
+    Prio_Node last = q->heap[q->size];
+    Prio_Queue_siftDown(q, 0, &last);
   }
-
-  return emptyPCB;
+  return removed;
 }
 
 /**
- * @brief Checks if the priority queue is empty.
+ * @brief Returns the head of the priority queue without removing it.
  *
  * @param q Pointer to the priority queue.
- * @return true if the priority queue is empty, false otherwise.
+ * @return Pointer to the head node, or NULL if the queue is empty. The pointer
+ * is invalidated by the next modification of the queue.
  */
-bool Prio_Queue_isEmpty(Prio_Queue* q) { return (bool)(q->head == NULL); }
+Prio_Node* Prio_Queue_peek(Prio_Queue* q) {
+  return q->size == 0 ? NULL : &q->heap[0];
+}
 
 /**
- * @brief Increments the waiting time of all process in the priority queue.
+ * @brief Checks if the priority queue is empty.
  *
  * @param q Pointer to the priority queue.
- * @param time Current time.
+ * @return true if the priority queue is empty, false otherwise.
  */
-void Prio_Queue_Inc_WaitingTime(Prio_Queue* q, int time) {
-  if (q->head == NULL) {
-    return;
-  }
-  struct Prio_Node* current = q->head;
-  while (current != NULL) {
-    if (current->process.arrivalTime < time) {
-      current->process.waitTime++;
-    }
-    current = current->next;
-  }
-}
+bool Prio_Queue_isEmpty(Prio_Queue* q) { return (bool)(q->size == 0); }
 
-#endif /* _PRIO_QUEUE_H_ */
\ No newline at end of file
+#endif /* _PRIO_QUEUE_H_ */
@@ -0,0 +1,150 @@
+/**
+ * @file SPSCRing.h
+ * @brief Header file for Single-Producer Single-Consumer Ring.
+ *
+ * The ring lives in shared memory and carries process records from the
+ * generator to the scheduler without any system call on the fast path. The
+ * processes arriving at a time step travel as one batch: a header slot with
+ * the time step and the number of processes, followed by their records. The
+ * producer only writes the tail and the consumer only writes the head, each
+ * on its own cache line. When the ring is full, the producer sleeps on a
+ * futex on the head, and the consumer wakes it only if it asked to be woken.
+ * Only the producer clears that request, once it has room: were the consumer
+ * to clear it, a request made again just before the wake would be lost.
+ */
+#ifndef _SPSC_RING_H_
+#define _SPSC_RING_H_
+
+#define SPSC_RING_LINE 64 /**< Size of a cache line */
+
+/**
+ * @brief Slot of the ring: a batch is a header slot followed by its records.
+ */
+typedef union SPSC_Slot {
+  struct BatchHeader header;   /**< First slot of a batch */
+  struct ProcessRecord record;  /**< Following slots of a batch */
+} SPSC_Slot;
+
+/**
+ * @brief Structure representing a ring, followed in memory by its slots.
+ */
+typedef struct SPSC_Ring {
+  _Alignas(SPSC_RING_LINE) unsigned int head; /**< Next slot to read */
+  unsigned int producerWaiting; /**< Set while the producer waits for room */
+  _Alignas(SPSC_RING_LINE) unsigned int tail; /**< Next slot to write */
+  _Alignas(SPSC_RING_LINE) unsigned int capacity; /**< Power of two */
+  _Alignas(SPSC_RING_LINE) union SPSC_Slot slots[]; /**< Slots */
+} SPSC_Ring;
+
+/**
+ * @brief Returns the number of bytes taken by a ring of a given capacity.
+ *
+ * @param capacity Number of slots, a power of two.
+ * @return Size of the ring in bytes.
+ */
+size_t SPSC_Ring_bytes(unsigned int capacity) {
+  return sizeof(SPSC_Ring) + capacity * sizeof(union SPSC_Slot);
+}
+
+/**
+ * @brief Initializes a ring placed in memory of SPSC_Ring_bytes(capacity).
+ *
+ * @param r Pointer to the ring.
+ * @param capacity Number of slots, a power of two.
+ */
+void SPSC_Ring_Init(SPSC_Ring* r, unsigned int capacity) {
+  r->head = 0;
+  r->producerWaiting = 0;
+  r->tail = 0;
+  r->capacity = capacity;
+}
+
+/**
+ * @brief Returns the number of free slots, from the producer side.
+ *
+ * @param r Pointer to the ring.
+ * @return Number of slots that can be written without waiting.
+ */
+unsigned int SPSC_Ring_free(SPSC_Ring* r) {
+  unsigned int head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+  return r->capacity - (r->tail - head);
+}
+
+/**
+ * @brief Appends the processes arriving at a time step as one batch, sleeping
+ * until the ring has room for all of them.
+ *
+ * The header and the records are published together, so the consumer never
+ * sees part of a batch.
+ *
+ * @param r Pointer to the ring.
+ * @param tick Time step the processes are sent at.
+ * @param records Records of the processes.
+ * @param count Number of processes, less than the capacity of the ring.
+ */
+void SPSC_Ring_pushBatch(SPSC_Ring* r, int tick,
+                         const struct ProcessRecord* records, int count) {
+  unsigned int needed = (unsigned int)count + 1;
+  unsigned int head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+  while (r->capacity - (r->tail - head) < needed) {
+    __atomic_store_n(&r->producerWaiting, 1, __ATOMIC_SEQ_CST);
+    /* Check again so a pop between the test and the flag is not missed */
+    if (__atomic_load_n(&r->head, __ATOMIC_SEQ_CST) == head) {
+      syscall(SYS_futex, &r->head, FUTEX_WAIT, head, NULL, NULL, 0);
+    }
+    head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+  }
+  if (r->producerWaiting) {
+    __atomic_store_n(&r->producerWaiting, 0, __ATOMIC_RELAXED);
+  }
+  unsigned int mask = r->capacity - 1;
+  r->slots[r->tail & mask].header.tick = tick;
+  r->slots[r->tail & mask].header.count = count;
+  for (int i = 0; i < count; i++) {
+    r->slots[(r->tail + 1 + i) & mask].record = records[i];
+  }
+  __atomic_store_n(&r->tail, r->tail + needed, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Reads the header of the oldest batch without taking it out.
+ *
+ * @param r Pointer to the ring.
+ * @param header Pointer to the header to be filled.
+ * @return true if a batch is waiting, false if the ring is empty.
+ */
+bool SPSC_Ring_peekBatch(SPSC_Ring* r, struct BatchHeader* header) {
+  unsigned int tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+  if (tail == r->head) {
+    return false;
+  }
+  *header = r->slots[r->head & (r->capacity - 1)].header;
+  return true;
+}
+
+/**
+ * @brief Returns a record of the oldest batch, which must have been peeked.
+ *
+ * @param r Pointer to the ring.
+ * @param i Index of the record in the batch.
+ * @return Pointer to the record, valid until the batch is popped.
+ */
+const struct ProcessRecord* SPSC_Ring_record(SPSC_Ring* r, int i) {
+  return &r->slots[(r->head + 1 + i) & (r->capacity - 1)].record;
+}
+
+/**
+ * @brief Takes the oldest batch out of the ring, waking the producer if it
+ * waits for room. The request to be woken is left for the producer to clear.
+ *
+ * @param r Pointer to the ring.
+ * @param header Header of the batch, as returned by SPSC_Ring_peekBatch.
+ */
+void SPSC_Ring_popBatch(SPSC_Ring* r, const struct BatchHeader* header) {
+  __atomic_store_n(&r->head, r->head + header->count + 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&r->producerWaiting, __ATOMIC_SEQ_CST)) {
+    syscall(SYS_futex, &r->head, FUTEX_WAKE, 1, NULL, NULL, 0);
+  }
+}
+
+#endif /* _SPSC_RING_H_ */
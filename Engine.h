@@ -0,0 +1,1170 @@
+/**
+ * @file Engine.h
+ * @brief Scheduling engine shared by the live scheduler and the simulator.
+ *
+ * The engine holds the state of HPF, SRTN, RR, MLFQ and CFS and decides what
+ * runs at every time step. It never touches real processes itself: creating,
+ * stopping, resuming and finishing them goes through hooks, which the live
+ * scheduler maps to its pool of workers, and the simulator leaves empty.
+ * Likewise, the remaining time of the running process is read from the
+ * driver through the progress hook when it has one, and counted down by the
+ * engine otherwise.
+ * Both drivers call Engine_step at every time step of the algorithm and
+ * Engine_arrive once with all the processes arriving at a time step, after
+ * the step itself, so they produce the same schedule.
+ *
+ * The engine models one or more CPUs. Every CPU has its own ready queue under
+ * the policy: arriving processes go to the least loaded CPU, a preempted
+ * process stays on its CPU, and an idle CPU with an empty queue steals the
+ * head of the longest queue. With a single CPU, this is the classic
+ * uniprocessor scheduler.
+ *
+ * MLFQ runs the processes of the highest non-empty level, each for the
+ * quantum of its level. A process that uses up its quantum is demoted one
+ * level, one preempted by a process of a higher level keeps what is left of
+ * its quantum, and every boost period all the processes go back to level 0.
+ *
+ * CFS runs the process with the smallest virtual runtime, which grows with
+ * the time a process ran divided by its weight, so the CPU is shared in
+ * proportion to the weights. prio acts as the nice value of the process.
+ * Instead of a fixed quantum, the target latency is split between the
+ * processes of a CPU by weight, but no slice is shorter than the minimum
+ * granularity.
+ */
+
+#ifndef _ENGINE_H_
+#define _ENGINE_H_
+
+/******************** MACROS ********************/
+#define __HPF__ 0                 /**< Highest Priority First */
+#define __SRTN__ 1                /**< Shortest Remaining Time Next */
+#define __RR__ 2                  /**< Round Robin */
+#define __MLFQ__ 3                /**< Multi-Level Feedback Queue */
+#define __CFS__ 4                 /**< Completely Fair Scheduler */
+#define __MAX_CPUS__ 1024         /**< Largest number of simulated CPUs */
+#define __MLFQ_LEVELS__ 3         /**< Default number of MLFQ levels */
+#define __MLFQ_BOOST__ 100        /**< Default MLFQ boost period */
+#define __CFS_LATENCY__ 6         /**< Default CFS target latency */
+#define __CFS_GRANULARITY__ 1     /**< Default CFS minimum granularity */
+#define __CFS_SCALE__ (1LL << 20) /**< Virtual runtime of a step at weight 1 */
+/************************************************/
+
+/**
+ * @brief CFS weight of every nice value from -20 to 19, as in Linux: one nice
+ * level apart, two processes get about 10% more or less of the CPU.
+ */
+static const int Engine_weights[40] = {
+    88761, 71755, 56483, 46273, 36291, 29154, 23254, 18705, 14949, 11916,
+    9548,  7620,  6100,  4904,  3906,  3121,  2501,  1991,  1586,  1277,
+    1024,  820,   655,   526,   423,   335,   272,   215,   172,   137,
+    110,   87,    70,    56,    45,    36,    29,    23,    18,    15};
+
+/**
+ * @brief Actions the engine asks its driver to apply to a process.
+ */
+typedef struct Engine_Hooks {
+  void (*start)(struct PCB* process);   /**< Creates it and sets its PID */
+  void (*resume)(struct PCB* process);  /**< Resumes it after a stop */
+  void (*stop)(struct PCB* process);    /**< Stops it from running */
+  void (*finish)(struct PCB* process);  /**< Ends it once it finished */
+  int (*progress)(struct PCB* process); /**< Its remaining time now */
+} Engine_Hooks;
+
+/**
+ * @brief State of a simulated CPU.
+ */
+typedef struct Engine_CPU {
+  bool currently;                /**< Currently running a process */
+  struct PCB process;            /**< Process currently executed */
+  struct Prio_Queue prioQueue;   /**< Ready queue of HPF and SRTN */
+  struct Circ_Queue circQueue;   /**< Ready queue of RR */
+  struct Level_Queue levelQueue; /**< Ready queue of MLFQ */
+  struct Fair_Tree fairTree;     /**< Ready queue of CFS */
+  long long minVruntime;         /**< Virtual runtime new processes start at */
+  long long queuedWeight;        /**< Sum of the weights in the fair tree */
+  int ran;                       /**< Time steps since it got the CPU */
+  long long busy;                /**< Time steps spent running processes */
+  int migrations;                /**< Processes that last ran on another CPU */
+  int steals;                    /**< Processes taken from another queue */
+} Engine_CPU;
+
+/**
+ * @brief State of the scheduling engine.
+ */
+typedef struct Engine {
+  int algo;                    /**< Scheduling algorithm */
+  int quantumSize;             /**< Quantum size for Round Robin */
+  int levels;                  /**< Number of MLFQ levels */
+  int levelQuantum[LEVEL_QUEUE_LEVELS]; /**< Quantum of every MLFQ level */
+  int boostPeriod;             /**< Time steps between MLFQ boosts, 0 never */
+  int latency;                 /**< CFS target latency */
+  int granularity;             /**< CFS minimum time slice */
+  int timeStep;                /**< Time steps between two engine steps */
+  int oldClk;                  /**< Time of the last engine step */
+  bool verbose;                /**< Print every scheduling event */
+  struct Trace* trace;         /**< Records every event, if not NULL */
+  bool arrived;                /**< Processes arrived since the last step */
+  int cpus;                    /**< Number of CPUs */
+  struct Engine_CPU* cpu;      /**< The CPUs */
+  int running;                 /**< Number of CPUs running a process */
+  int ready;                   /**< Processes in the ready queues */
+  struct Mem_Queue memoryWait; /**< Processes waiting for memory */
+  Engine_Hooks hooks;          /**< Actions applied to processes */
+  int finished;                /**< Number of finished processes */
+  int rejected;                /**< Number of rejected processes */
+  long long switches;          /**< Times a process was given a CPU */
+  long long totalRun;          /**< Sum of the run times */
+  long long totalWait;         /**< Sum of the waiting times */
+  double totalWeighted;        /**< Sum of the weighted turnaround times */
+  double meanWeighted;         /**< Running mean of the weighted turnarounds */
+  double squaresWeighted;      /**< Sum of their squared deviations */
+  struct Histogram waits;      /**< Waiting times of the finished processes */
+  struct Histogram turnaround; /**< Their turnaround times */
+  int lastEnd;                 /**< End time of the last finished process */
+} Engine;
+
+/**
+ * @brief Returns the line the log of an algorithm starts with.
+ *
+ * @param algo Scheduling algorithm.
+ * @return The banner of the algorithm.
+ */
+const char* Engine_banner(int algo) {
+  if (algo == __HPF__) {
+    return "============ HPF =============";
+  } else if (algo == __SRTN__) {
+    return "============ SRTN ============";
+  } else if (algo == __RR__) {
+    return "============= RR =============";
+  } else if (algo == __MLFQ__) {
+    return "============ MLFQ ============";
+  }
+  return "============ CFS =============";
+}
+
+/**
+ * @brief Initializes the engine.
+ *
+ * @param e Pointer to the engine.
+ * @param algo Scheduling algorithm.
+ * @param quantumSize Quantum size for Round Robin, and of the top MLFQ level.
+ * @param cpus Number of CPUs, from 1 to __MAX_CPUS__.
+ * @param clk Current time step.
+ * @param hooks Actions applied to processes.
+ * @param verbose Print every scheduling event.
+ */
+void Engine_Init(Engine* e, int algo, int quantumSize, int cpus, int clk,
+                 Engine_Hooks hooks, bool verbose) {
+  e->algo = algo;
+  e->quantumSize = quantumSize;
+  /* MLFQ levels double their quantum by default */
+  e->levels = __MLFQ_LEVELS__;
+  for (int l = 0; l < __MLFQ_LEVELS__; l++) {
+    e->levelQuantum[l] = quantumSize << l;
+  }
+  e->boostPeriod = __MLFQ_BOOST__;
+  e->latency = __CFS_LATENCY__;
+  e->granularity = __CFS_GRANULARITY__;
+  e->timeStep = (algo == __RR__) ? quantumSize : 1;
+  e->oldClk = clk;
+  e->verbose = verbose;
+  e->trace = NULL;
+  e->arrived = false;
+  e->cpus = cpus;
+  e->cpu = (Engine_CPU*)calloc(cpus, sizeof(Engine_CPU));  // NOLINT
+  if (e->cpu == NULL) {
+    perror("Error in allocating the CPUs");
+    exit(-1);
+  }
+  for (int c = 0; c < cpus; c++) {
+    e->cpu[c].currently = false;
+    e->cpu[c].process.id = -1; /**< To disable unreasonable stopping */
+    Prio_Queue_Init(&e->cpu[c].prioQueue);
+    Circ_Queue_Init(&e->cpu[c].circQueue);
+    Level_Queue_Init(&e->cpu[c].levelQueue);
+    Fair_Tree_Init(&e->cpu[c].fairTree);
+  }
+  e->running = 0;
+  e->ready = 0;
+  Mem_Queue_Init(&e->memoryWait);
+  e->hooks = hooks;
+  e->finished = 0;
+  e->rejected = 0;
+  e->switches = 0;
+  e->totalRun = 0;
+  e->totalWait = 0;
+  e->totalWeighted = 0;
+  e->meanWeighted = 0;
+  e->squaresWeighted = 0;
+  Histogram_Init(&e->waits);
+  Histogram_Init(&e->turnaround);
+  e->lastEnd = clk;
+  if (verbose) {
+    printf("%s\n", Engine_banner(algo));
+  }
+}
+
+/**
+ * @brief Releases the memory held by the engine.
+ *
+ * @param e Pointer to the engine.
+ */
+void Engine_destroy(Engine* e) {
+  for (int c = 0; c < e->cpus; c++) {
+    Prio_Queue_Destroy(&e->cpu[c].prioQueue);
+    Circ_Queue_Destroy(&e->cpu[c].circQueue);
+    Level_Queue_Destroy(&e->cpu[c].levelQueue);
+    Fair_Tree_Destroy(&e->cpu[c].fairTree);
+  }
+  Mem_Queue_Destroy(&e->memoryWait);
+  free(e->cpu);
+  e->cpu = NULL;
+}
+
+/**
+ * @brief Parses a comma separated list of MLFQ quanta, e.g. 2,4,8.
+ *
+ * @param text The list.
+ * @param quanta Array of LEVEL_QUEUE_LEVELS quanta to be filled.
+ * @return Number of levels read.
+ */
+int Engine_parseLevels(const char* text, int* quanta) {
+  int levels = 0;
+  const char* cursor = text;
+  while (*cursor != '\0') {
+    char* end;
+    long quantum = strtol(cursor, &end, 10);
+    if (end == cursor || quantum < 1 || quantum > INT_MAX ||
+        levels == LEVEL_QUEUE_LEVELS || (*end != ',' && *end != '\0')) {
+      break;
+    }
+    quanta[levels++] = (int)quantum;
+    cursor = *end == ',' ? end + 1 : end;
+  }
+  if (levels == 0 || *cursor != '\0') {
+    fprintf(stderr, "Invalid MLFQ levels %s\n", text);
+    exit(-1);
+  }
+  return levels;
+}
+
+/**
+ * @brief Sets the MLFQ levels and boost period, before any process arrived.
+ *
+ * @param e Pointer to the engine.
+ * @param quanta Comma separated quantum of every level from the top one, or
+ * NULL to keep the default levels.
+ * @param boostPeriod Time steps between two boosts, 0 to never boost, or a
+ * negative value to keep the default period.
+ */
+void Engine_setLevels(Engine* e, const char* quanta, int boostPeriod) {
+  if (quanta != NULL) {
+    e->levels = Engine_parseLevels(quanta, e->levelQuantum);
+  }
+  if (boostPeriod >= 0) {
+    e->boostPeriod = boostPeriod;
+  }
+}
+
+/**
+ * @brief Sets the CFS target latency and minimum granularity, before any
+ * process arrived.
+ *
+ * @param e Pointer to the engine.
+ * @param latency Time steps every process of a CPU should run within, or a
+ * non-positive value to keep the default.
+ * @param granularity Shortest time slice, or a non-positive value to keep
+ * the default.
+ */
+void Engine_setFair(Engine* e, int latency, int granularity) {
+  if (latency > 0) {
+    e->latency = latency;
+  }
+  if (granularity > 0) {
+    e->granularity = granularity;
+  }
+}
+
+/**
+ * @brief Returns the number of processes in the ready queue of a CPU.
+ */
+int Engine_queueSize(Engine* e, Engine_CPU* cpu) {
+  if (e->algo == __RR__) {
+    return cpu->circQueue.size;
+  } else if (e->algo == __MLFQ__) {
+    return cpu->levelQueue.size;
+  } else if (e->algo == __CFS__) {
+    return cpu->fairTree.size;
+  }
+  return cpu->prioQueue.size;
+}
+
+/**
+ * @brief Checks if every ready queue is empty.
+ */
+bool Engine_readyEmpty(Engine* e) { return (bool)(e->ready == 0); }
+
+/**
+ * @brief Checks if the engine has nothing left to run.
+ *
+ * @param e Pointer to the engine.
+ * @return true if no process is running, ready or waiting for memory.
+ */
+bool Engine_isIdle(Engine* e) {
+  return (bool)(e->running == 0 && Engine_readyEmpty(e) &&
+                Mem_Queue_isEmpty(&e->memoryWait));
+}
+
+/**
+ * @brief Records every scheduling event from now on in a binary trace.
+ *
+ * @param e Pointer to the engine.
+ * @param trace Pointer to the open trace.
+ */
+void Engine_setTrace(Engine* e, struct Trace* trace) { e->trace = trace; }
+
+/**
+ * @brief Records an event in the trace, if there is one.
+ *
+ * @param e Pointer to the engine.
+ * @param kind Kind of the event.
+ * @param tick Time step of the event.
+ * @param cpu Pointer to the CPU of the event, NULL if it has none.
+ * @param process Pointer to the PCB of the process.
+ */
+void Engine_trace(Engine* e, TraceKind kind, int tick, Engine_CPU* cpu,
+                  const struct PCB* process) {
+  if (e->trace != NULL) {
+    Trace_write(e->trace, kind, tick, cpu == NULL ? 0 : (int)(cpu - e->cpu),
+                process);
+  }
+}
+
+/**
+ * @brief Prints the CPU an event happened on, when there is more than one.
+ *
+ * @param e Pointer to the engine.
+ * @param cpu Pointer to the CPU.
+ */
+void Engine_printCPU(Engine* e, Engine_CPU* cpu) {
+  if (e->cpus > 1) {
+    printf(" on CPU %d", (int)(cpu - e->cpu));
+  }
+}
+
+/**
+ * @brief Returns the key a process is ordered by under the algorithm.
+ *
+ * @param e Pointer to the engine.
+ * @param pcb Pointer to the PCB.
+ * @return Its priority for HPF, its remaining time for SRTN, 0 for RR, MLFQ
+ * and CFS.
+ */
+int Engine_policyKey(Engine* e, const struct PCB* pcb) {
+  if (e->algo == __HPF__) {
+    return pcb->prio;
+  } else if (e->algo == __SRTN__) {
+    return pcb->remainingTime;
+  }
+  return 0;
+}
+
+/**
+ * @brief Returns the CFS weight of a process, its prio being its nice value.
+ */
+int Engine_weight(const struct PCB* pcb) {
+  int nice = pcb->prio < -20 ? -20 : (pcb->prio > 19 ? 19 : pcb->prio);
+  return Engine_weights[nice + 20];
+}
+
+/**
+ * @brief Moves the virtual runtime new processes of a CPU start at up to the
+ * smallest one of its running and queued processes; it never goes down.
+ */
+void Engine_updateMinVruntime(Engine_CPU* cpu) {
+  long long floor = cpu->currently ? cpu->process.vruntime : LLONG_MAX;
+  Fair_Node* head = Fair_Tree_peek(&cpu->fairTree);
+  if (head != NULL && head->key < floor) {
+    floor = head->key;
+  }
+  if (floor != LLONG_MAX && floor > cpu->minVruntime) {
+    cpu->minVruntime = floor;
+  }
+}
+
+/**
+ * @brief Returns the CFS time slice of the process running on a CPU: its
+ * share of the target latency by weight, stretched when more processes than
+ * the latency allows at the minimum granularity share the CPU.
+ */
+int Engine_slice(Engine* e, Engine_CPU* cpu) {
+  long long weight = Engine_weight(&cpu->process);
+  long long period = e->latency;
+  long long running = 1 + cpu->fairTree.size;
+  if (running * e->granularity > period) {
+    period = running * e->granularity;
+  }
+  long long slice = period * weight / (weight + cpu->queuedWeight);
+  return slice < e->granularity ? e->granularity : (int)slice;
+}
+
+/**
+ * @brief Records that the process running on a CPU ran for some time steps.
+ */
+void Engine_chargeFair(Engine_CPU* cpu, int steps) {
+  cpu->ran += steps;
+  cpu->process.vruntime +=
+      steps * (__CFS_SCALE__ / Engine_weight(&cpu->process));
+  Engine_updateMinVruntime(cpu);
+}
+
+/**
+ * @brief Records that a process entered the ready queue.
+ *
+ * Waiting time is counted in time steps: every step a queued process sees
+ * adds one to its waitTime, except the steps it sees before or at its arrival.
+ * Instead of visiting the whole queue on every step, the first step that will
+ * count is stored in readyTime, and the steps are added up once the process
+ * leaves the queue.
+ *
+ * @param e Pointer to the engine.
+ * @param pcb Pointer to the PCB entering the queue.
+ */
+void Engine_markReady(Engine* e, struct PCB* pcb) {
+  int clk = e->oldClk;
+  int first = pcb->arrivalTime + 1;
+  if (first <= clk) {
+    pcb->readyTime = clk;
+  } else {
+    /* Round up to the next time step of the algorithm */
+    pcb->readyTime =
+        clk + ((first - clk + e->timeStep - 1) / e->timeStep) * e->timeStep;
+  }
+}
+
+/**
+ * @brief Adds the time steps a process spent in the ready queue to its
+ * waiting time.
+ *
+ * @param e Pointer to the engine.
+ * @param pcb Pointer to the PCB leaving the queue.
+ */
+void Engine_chargeWaitingTime(Engine* e, struct PCB* pcb) {
+  if (e->oldClk > pcb->readyTime) {
+    pcb->waitTime += (e->oldClk - pcb->readyTime) / e->timeStep;
+  }
+}
+
+/**
+ * @brief Picks the CPU a new process is queued on: the one with the fewest
+ * running and ready processes, the lowest index on a tie.
+ *
+ * @param e Pointer to the engine.
+ * @return Pointer to the CPU.
+ */
+Engine_CPU* Engine_place(Engine* e) {
+  Engine_CPU* best = &e->cpu[0];
+  int bestLoad = Engine_queueSize(e, best) + best->currently;
+  for (int c = 1; c < e->cpus && bestLoad > 0; c++) {
+    int load = Engine_queueSize(e, &e->cpu[c]) + e->cpu[c].currently;
+    if (load < bestLoad) {
+      best = &e->cpu[c];
+      bestLoad = load;
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief Inserts a process into the ready queue of a CPU.
+ */
+void Engine_enqueueReady(Engine* e, Engine_CPU* cpu, struct PCB process) {
+  PROBE_BEGIN(begin);
+  if (e->algo == __RR__) {
+    Circ_Queue_enqueue(&cpu->circQueue, process);
+  } else if (e->algo == __MLFQ__) {
+    Level_Queue_enqueue(&cpu->levelQueue, process.level, process);
+  } else if (e->algo == __CFS__) {
+    if (process.state == _NEW) {
+      /* A new process starts level with the processes already there */
+      process.vruntime = cpu->minVruntime;
+    }
+    Fair_Tree_insert(&cpu->fairTree, process.vruntime, process);
+    cpu->queuedWeight += Engine_weight(&process);
+  } else {
+    Prio_Queue_enqueue(&cpu->prioQueue, Engine_policyKey(e, &process),
+                       process);
+  }
+  e->ready++;
+  PROBE_END(_PROBE_ENQUEUE, begin);
+}
+
+/**
+ * @brief Spreads the processes of a batch over the ready queues, restoring
+ * every priority queue once for the whole batch.
+ */
+void Engine_enqueueReadyBatch(Engine* e, struct PCB* pcbs, int count) {
+  if (e->algo != __HPF__ && e->algo != __SRTN__) {
+    for (int i = 0; i < count; i++) {
+      Engine_enqueueReady(e, Engine_place(e), pcbs[i]);
+    }
+    return;
+  }
+  int from[e->cpus];
+  for (int c = 0; c < e->cpus; c++) {
+    from[c] = e->cpu[c].prioQueue.size;
+  }
+  for (int i = 0; i < count; i++) {
+    Prio_Queue_append(&Engine_place(e)->prioQueue,
+                      Engine_policyKey(e, &pcbs[i]), pcbs[i]);
+    e->ready++;
+  }
+  for (int c = 0; c < e->cpus; c++) {
+    Prio_Queue_heapify(&e->cpu[c].prioQueue, from[c]);
+  }
+}
+
+/**
+ * @brief Takes the next process out of the ready queue of a CPU.
+ */
+struct PCB Engine_dequeueReady(Engine* e, Engine_CPU* cpu) {
+  PROBE_BEGIN(begin);
+  struct PCB process;
+  e->ready--;
+  if (e->algo == __RR__) {
+    process = Circ_Queue_dequeue(&cpu->circQueue);
+  } else if (e->algo == __MLFQ__) {
+    process = Level_Queue_dequeue(&cpu->levelQueue);
+  } else if (e->algo == __CFS__) {
+    process = Fair_Tree_dequeue(&cpu->fairTree);
+    cpu->queuedWeight -= Engine_weight(&process);
+    Engine_updateMinVruntime(cpu);
+  } else {
+    process = Prio_Queue_dequeue(&cpu->prioQueue);
+  }
+  PROBE_END(_PROBE_DEQUEUE, begin);
+  return process;
+}
+
+/**
+ * @brief Takes the next process out of the longest ready queue, for a CPU
+ * whose own queue is empty.
+ *
+ * @param e Pointer to the engine.
+ * @param thief Pointer to the idle CPU.
+ * @return The stolen process.
+ */
+struct PCB Engine_steal(Engine* e, Engine_CPU* thief) {
+  Engine_CPU* victim = NULL;
+  int longest = 0;
+  for (int c = 0; c < e->cpus; c++) {
+    int size = Engine_queueSize(e, &e->cpu[c]);
+    if (size > longest) {
+      victim = &e->cpu[c];
+      longest = size;
+    }
+  }
+  thief->steals++;
+  struct PCB process = Engine_dequeueReady(e, victim);
+  if (e->algo == __CFS__) {
+    /* Keep its lead or lag relative to the processes of its new CPU */
+    process.vruntime += thief->minVruntime - victim->minVruntime;
+  }
+  return process;
+}
+
+/**
+ * @brief Gives a CPU to a process taken from a ready queue.
+ *
+ * A preempted process is resumed. A new process is started if its memory can
+ * be allocated; otherwise it is parked in the memory-wait queue, where it
+ * stays until a finishing process frees enough memory.
+ *
+ * @param e Pointer to the engine.
+ * @param cpu Pointer to the CPU.
+ * @return true if the process is now running, false if it was parked.
+ */
+bool Engine_dispatch(Engine* e, Engine_CPU* cpu) {
+  struct PCB* process = &cpu->process;
+  int c = (int)(cpu - e->cpu);
+  if (process->state == _READY) {
+    if (process->cpu != c) {
+      cpu->migrations++;
+    }
+    process->cpu = c;
+    process->state = _RUNNING;
+    cpu->ran = 0;
+    e->hooks.resume(process);
+    e->running++;
+    e->switches++;
+    Engine_trace(e, _TRACE_RESUME, e->oldClk, cpu, process);
+    return true;
+  }
+  process->memPointer = allocate(process->memory);
+  if (process->memPointer == NULL) {
+    /* Keep counting its waiting time while it is parked */
+    Engine_markReady(e, process);
+    Mem_Queue_enqueue(&e->memoryWait, Engine_policyKey(e, process), *process);
+    return false;
+  }
+  process->cpu = c;
+  process->startTime = e->oldClk;
+  process->state = _RUNNING;
+  cpu->ran = 0;
+  e->hooks.start(process);
+  e->running++;
+  e->switches++;
+  Engine_trace(e, _TRACE_START, e->oldClk, cpu, process);
+  if (e->verbose) {
+    printf("At time = %d, new process with ID = %d started running",
+           e->oldClk, process->id);
+    Engine_printCPU(e, cpu);
+    printf("\n");
+  }
+  return true;
+}
+
+/**
+ * @brief Runs the best ready process that fits in memory on every idle CPU.
+ *
+ * Idle CPUs first take from their own queue; only then does a CPU whose queue
+ * is empty steal, so it never takes the work of another idle CPU.
+ */
+void Engine_dispatchNext(Engine* e) {
+  for (int c = 0; c < e->cpus; c++) {
+    Engine_CPU* cpu = &e->cpu[c];
+    while (cpu->currently == false && Engine_queueSize(e, cpu) > 0) {
+      cpu->process = Engine_dequeueReady(e, cpu);
+      Engine_chargeWaitingTime(e, &cpu->process);
+      cpu->currently = Engine_dispatch(e, cpu);
+    }
+  }
+  for (int c = 0; c < e->cpus && !Engine_readyEmpty(e); c++) {
+    Engine_CPU* cpu = &e->cpu[c];
+    while (cpu->currently == false && !Engine_readyEmpty(e)) {
+      cpu->process = Engine_steal(e, cpu);
+      Engine_chargeWaitingTime(e, &cpu->process);
+      cpu->currently = Engine_dispatch(e, cpu);
+    }
+  }
+}
+
+/**
+ * @brief Moves the parked processes that fit in the free memory back into the
+ * ready queues.
+ *
+ * Classes are visited from the smallest one, under a single budget of free
+ * bytes that every woken process uses up by the size of its block or slot, so
+ * the smaller classes are never woken into memory a larger class was counted
+ * on. No more processes of a class are woken than requests of its size fit
+ * either, and a class that fits nothing ends the walk, since no larger class
+ * can fit either.
+ */
+void Engine_wake(Engine* e) {
+  MemoryStats stats = getMemoryStats();
+  size_t budget = stats.freeBytes + stats.freeSlotBytes;
+  int k = Mem_Queue_nextClass(&e->memoryWait, 0);
+  while (k != -1) {
+    int order = k < globalAllocator.slabOrder ? globalAllocator.slabOrder : k;
+    size_t fitting = countFittingAllocations((size_t)1 << k);
+    if (fitting > budget >> order) {
+      fitting = budget >> order;
+    }
+    if (fitting == 0) {
+      break;
+    }
+    while (fitting > 0 && !Prio_Queue_isEmpty(&e->memoryWait.classes[k])) {
+      Engine_enqueueReady(e, Engine_place(e),
+                          Mem_Queue_dequeue(&e->memoryWait, k));
+      budget -= (size_t)1 << order;
+      fitting--;
+    }
+    k = Mem_Queue_nextClass(&e->memoryWait, k + 1);
+  }
+}
+
+/**
+ * @brief Terminates the process running on a CPU, frees its memory and wakes
+ * the processes that fit now.
+ */
+void Engine_finish(Engine* e, Engine_CPU* cpu) {
+  cpu->currently = false;
+  e->running--;
+  cpu->process.endTime = e->oldClk;
+  cpu->process.state = _TERMINATED;
+  e->hooks.finish(&cpu->process);
+  Engine_trace(e, _TRACE_FINISH, e->oldClk, cpu, &cpu->process);
+  deallocate(cpu->process.memPointer);
+  if (e->verbose) {
+    printf("At time = %d, process with ID = %d, has finished", e->oldClk,
+           cpu->process.id);
+    Engine_printCPU(e, cpu);
+    printf("\n");
+  }
+  e->finished++;
+  e->totalRun += cpu->process.runTime;
+  e->totalWait += cpu->process.waitTime;
+  int turnaround = cpu->process.endTime - cpu->process.arrivalTime;
+  double weighted = 0;
+  if (cpu->process.runTime > 0) {
+    weighted = (double)turnaround / cpu->process.runTime;
+    e->totalWeighted += weighted;
+  }
+  /* Welford's update keeps the deviation accurate over long runs */
+  double delta = weighted - e->meanWeighted;
+  e->meanWeighted += delta / e->finished;
+  e->squaresWeighted += delta * (weighted - e->meanWeighted);
+  Histogram_record(&e->waits, cpu->process.waitTime);
+  Histogram_record(&e->turnaround, turnaround);
+  e->lastEnd = cpu->process.endTime;
+  Engine_wake(e);
+}
+
+/**
+ * @brief Takes the CPU away from its running process, which goes back to the
+ * ready queue of the same CPU.
+ */
+void Engine_preempt(Engine* e, Engine_CPU* cpu) {
+  cpu->currently = false;
+  e->running--;
+  e->hooks.stop(&cpu->process);
+  Engine_trace(e, _TRACE_STOP, e->oldClk, cpu, &cpu->process);
+  cpu->process.state = _READY;
+  Engine_markReady(e, &cpu->process);
+  Engine_enqueueReady(e, cpu, cpu->process);
+}
+
+/**
+ * @brief Admits the processes that arrived at the given time step.
+ *
+ * The whole batch enters the ready queues before a single dispatch decision,
+ * so an idle CPU goes to the best process of the batch rather than to the
+ * first one received. A process that needs more memory than the whole pool is
+ * rejected, since it would otherwise wait forever.
+ *
+ * @param e Pointer to the engine.
+ * @param pcbs The arriving processes, with id, arrival, run time, priority and
+ * memory set. The array is used as scratch space.
+ * @param count Number of arriving processes.
+ * @param clk Current time step.
+ */
+void Engine_arrive(Engine* e, struct PCB* pcbs, int count, int clk) {
+  int admitted = 0;
+  for (int i = 0; i < count; i++) {
+    struct PCB pcb = pcbs[i];
+    /* Set the data that is not sent with the process */
+    pcb.remainingTime = pcb.runTime;
+    pcb.state = _NEW;
+    pcb.waitTime = 0;
+    pcb.memPointer = NULL;
+    pcb.worker = -1;
+    pcb.cpu = -1;
+    pcb.level = 0;
+    pcb.slice = e->levelQuantum[0];
+    if ((size_t)pcb.memory > globalAllocator.totalSize) {
+      if (e->verbose) {
+        printf("At time = %d, rejected process with ID = %d, needs %d bytes\n",
+               clk, pcb.id, pcb.memory);
+      }
+      Engine_trace(e, _TRACE_REJECT, clk, NULL, &pcb);
+      e->rejected++;
+      continue;
+    }
+    Engine_markReady(e, &pcb);
+    if (e->verbose) {
+      printf("At time = %d, received process with ID = %d\n", clk, pcb.id);
+    }
+    Engine_trace(e, _TRACE_RECEIVE, clk, NULL, &pcb);
+    pcbs[admitted++] = pcb;
+  }
+  if (admitted > 0) {
+    Engine_enqueueReadyBatch(e, pcbs, admitted);
+    e->arrived = true;
+  }
+  Engine_dispatchNext(e);
+}
+
+/**
+ * @brief Updates the remaining time of the process running on a CPU at the
+ * current engine step, from the driver if it reports progress, or by counting
+ * down the time step otherwise.
+ *
+ * @param e Pointer to the engine.
+ * @param cpu Pointer to the CPU.
+ */
+void Engine_advance(Engine* e, Engine_CPU* cpu) {
+  int before = cpu->process.remainingTime;
+  if (e->hooks.progress != NULL) {
+    cpu->process.remainingTime = e->hooks.progress(&cpu->process);
+  } else {
+    cpu->process.remainingTime -= e->timeStep;
+  }
+  int after = cpu->process.remainingTime > 0 ? cpu->process.remainingTime : 0;
+  cpu->busy += before - after;
+}
+
+/**
+ * @brief Prints and records the remaining time of the process running on a
+ * CPU.
+ */
+void Engine_printRemaining(Engine* e, Engine_CPU* cpu) {
+  Engine_trace(e, _TRACE_REMAINING, e->oldClk, cpu, &cpu->process);
+  if (e->verbose) {
+    printf("At time = %d, ID = %d, remaining time = %d", e->oldClk,
+           cpu->process.id, cpu->process.remainingTime);
+    Engine_printCPU(e, cpu);
+    printf("\n");
+  }
+}
+
+/**
+ * @brief One time step of Highest Priority First: a running process keeps its
+ * CPU until it finishes.
+ */
+void Engine_stepHPF(Engine* e) {
+  for (int c = 0; c < e->cpus; c++) {
+    Engine_CPU* cpu = &e->cpu[c];
+    if (cpu->currently == true) {
+      Engine_advance(e, cpu);
+      if (cpu->process.remainingTime <= 0) {
+        Engine_finish(e, cpu);
+      } else {
+        Engine_printRemaining(e, cpu);
+      }
+    }
+  }
+  Engine_dispatchNext(e);
+}
+
+/**
+ * @brief One time step of Shortest Remaining Time Next: a running process is
+ * preempted as soon as a process queued on its CPU has no more time left to
+ * run.
+ */
+void Engine_stepSRTN(Engine* e) {
+  for (int c = 0; c < e->cpus; c++) {
+    Engine_CPU* cpu = &e->cpu[c];
+    if (cpu->process.id != -1 && cpu->process.state == _RUNNING) {
+      Engine_advance(e, cpu);
+      if (cpu->process.remainingTime <= 0) {
+        Engine_finish(e, cpu);
+      } else {
+        Engine_printRemaining(e, cpu);
+        /* Preempt only if the head of the queue would be dequeued before
+         * the running process once it is inserted back */
+        struct Prio_Node* head = Prio_Queue_peek(&cpu->prioQueue);
+        if (head != NULL && head->prio <= cpu->process.remainingTime) {
+          Engine_preempt(e, cpu);
+        }
+      }
+    }
+  }
+  Engine_dispatchNext(e);
+}
+
+/**
+ * @brief One quantum of Round Robin: every running process is stopped and
+ * goes to the back of the queue of its CPU unless it finished.
+ */
+void Engine_stepRR(Engine* e) {
+  for (int c = 0; c < e->cpus; c++) {
+    Engine_CPU* cpu = &e->cpu[c];
+    if (cpu->process.id != -1 && cpu->process.state == _RUNNING) {
+      /* Read the progress before the process is stopped */
+      Engine_advance(e, cpu);
+      if (cpu->process.remainingTime <= 0) {
+        Engine_finish(e, cpu);
+      } else {
+        Engine_preempt(e, cpu);
+        Engine_printRemaining(e, cpu);
+      }
+    }
+  }
+  Engine_dispatchNext(e);
+}
+
+/**
+ * @brief Moves every process of every CPU back to the top MLFQ level, with a
+ * fresh quantum. The queued processes keep their order, level by level.
+ */
+void Engine_boost(Engine* e) {
+  for (int c = 0; c < e->cpus; c++) {
+    Engine_CPU* cpu = &e->cpu[c];
+    if (cpu->currently && cpu->process.level > 0) {
+      cpu->process.level = 0;
+      cpu->process.slice = e->levelQuantum[0];
+    }
+    for (int l = 1; l < e->levels; l++) {
+      while (!Circ_Queue_isEmpty(&cpu->levelQueue.levels[l])) {
+        struct PCB pcb = Level_Queue_dequeueLevel(&cpu->levelQueue, l);
+        pcb.level = 0;
+        pcb.slice = e->levelQuantum[0];
+        Level_Queue_enqueue(&cpu->levelQueue, 0, pcb);
+      }
+    }
+  }
+}
+
+/**
+ * @brief One time step of the Multi-Level Feedback Queue: a running process
+ * is demoted once it used up its quantum, and preempted as soon as a process
+ * of a higher level is queued on its CPU.
+ */
+void Engine_stepMLFQ(Engine* e) {
+  for (int c = 0; c < e->cpus; c++) {
+    Engine_CPU* cpu = &e->cpu[c];
+    if (cpu->process.id != -1 && cpu->process.state == _RUNNING) {
+      Engine_advance(e, cpu);
+      if (cpu->process.remainingTime <= 0) {
+        Engine_finish(e, cpu);
+        continue;
+      }
+      Engine_printRemaining(e, cpu);
+      int top = Level_Queue_top(&cpu->levelQueue);
+      if (--cpu->process.slice <= 0) {
+        if (cpu->process.level < e->levels - 1) {
+          cpu->process.level++;
+        }
+        cpu->process.slice = e->levelQuantum[cpu->process.level];
+        Engine_preempt(e, cpu);
+      } else if (top != -1 && top < cpu->process.level) {
+        Engine_preempt(e, cpu);
+      }
+    }
+  }
+  if (e->boostPeriod > 0 && e->oldClk % e->boostPeriod == 0) {
+    Engine_boost(e);
+  }
+  Engine_dispatchNext(e);
+}
+
+/**
+ * @brief One time step of the Completely Fair Scheduler: a running process is
+ * preempted once it used up its slice, if another process waits on its CPU.
+ */
+void Engine_stepCFS(Engine* e) {
+  for (int c = 0; c < e->cpus; c++) {
+    Engine_CPU* cpu = &e->cpu[c];
+    if (cpu->process.id != -1 && cpu->process.state == _RUNNING) {
+      Engine_advance(e, cpu);
+      Engine_chargeFair(cpu, e->timeStep);
+      if (cpu->process.remainingTime <= 0) {
+        Engine_finish(e, cpu);
+        continue;
+      }
+      Engine_printRemaining(e, cpu);
+      if (!Fair_Tree_isEmpty(&cpu->fairTree) &&
+          cpu->ran >= Engine_slice(e, cpu)) {
+        Engine_preempt(e, cpu);
+      }
+    }
+  }
+  Engine_dispatchNext(e);
+}
+
+/**
+ * @brief Runs the engine step at the given time, which must be timeStep after
+ * the previous one.
+ *
+ * @param e Pointer to the engine.
+ * @param clk Current time step.
+ */
+void Engine_step(Engine* e, int clk) {
+  e->oldClk = clk;
+  e->arrived = false;
+  if (e->algo == __HPF__) {
+    Engine_stepHPF(e);
+  } else if (e->algo == __SRTN__) {
+    Engine_stepSRTN(e);
+  } else if (e->algo == __RR__) {
+    Engine_stepRR(e);
+  } else if (e->algo == __MLFQ__) {
+    Engine_stepMLFQ(e);
+  } else {
+    Engine_stepCFS(e);
+  }
+}
+
+/**
+ * @brief Returns the time of the next engine step that can change more than
+ * the remaining times of the running processes, assuming nothing arrives
+ * before.
+ *
+ * @param e Pointer to the engine.
+ * @return The time step, or INT_MAX if only an arrival can change anything.
+ */
+int Engine_nextEvent(Engine* e) {
+  if (e->arrived || (e->running < e->cpus && !Engine_readyEmpty(e))) {
+    return e->oldClk + e->timeStep;
+  }
+  if (e->running == 0) {
+    return INT_MAX;
+  }
+  int next = INT_MAX;
+  for (int c = 0; c < e->cpus; c++) {
+    Engine_CPU* cpu = &e->cpu[c];
+    if (!cpu->currently) {
+      continue;
+    }
+    int end;
+    if (e->algo == __RR__) {
+      /* Rotating a process that is alone in the queue changes nothing */
+      if (!Circ_Queue_isEmpty(&cpu->circQueue)) {
+        return e->oldClk + e->timeStep;
+      }
+      int quanta =
+          (cpu->process.remainingTime + e->quantumSize - 1) / e->quantumSize;
+      end = e->oldClk + quanta * e->quantumSize;
+    } else if (e->algo == __MLFQ__) {
+      /* A queued process of a higher level preempts at the next step */
+      int top = Level_Queue_top(&cpu->levelQueue);
+      if (top != -1 && top < cpu->process.level) {
+        return e->oldClk + e->timeStep;
+      }
+      int left = cpu->process.remainingTime < cpu->process.slice
+                     ? cpu->process.remainingTime
+                     : cpu->process.slice;
+      end = e->oldClk + left;
+    } else if (e->algo == __CFS__ && !Fair_Tree_isEmpty(&cpu->fairTree)) {
+      /* The slice does not change until something arrives or leaves */
+      int left = Engine_slice(e, cpu) - cpu->ran;
+      if (left < 1) {
+        left = 1;
+      }
+      if (cpu->process.remainingTime < left) {
+        left = cpu->process.remainingTime;
+      }
+      end = e->oldClk + left;
+    } else {
+      end = e->oldClk + cpu->process.remainingTime;
+    }
+    if (end < next) {
+      next = end;
+    }
+  }
+  if (e->algo == __MLFQ__ && e->boostPeriod > 0) {
+    int boost = (e->oldClk / e->boostPeriod + 1) * e->boostPeriod;
+    if (boost < next) {
+      next = boost;
+    }
+  }
+  return next;
+}
+
+/**
+ * @brief Fast-forwards over the engine steps before the given time, which
+ * must not be later than Engine_nextEvent.
+ *
+ * @param e Pointer to the engine.
+ * @param clk Time step to fast-forward to.
+ */
+void Engine_skip(Engine* e, int clk) {
+  int skipped = ((clk - 1 - e->oldClk) / e->timeStep) * e->timeStep;
+  if (skipped <= 0) {
+    return;
+  }
+  for (int c = 0; c < e->cpus; c++) {
+    if (e->cpu[c].currently) {
+      e->cpu[c].process.remainingTime -= skipped;
+      e->cpu[c].process.slice -= skipped;
+      e->cpu[c].busy += skipped;
+      if (e->algo == __CFS__) {
+        Engine_chargeFair(&e->cpu[c], skipped);
+      }
+    }
+  }
+  e->oldClk += skipped;
+}
+
+/**
+ * @brief Prints the share of the time every CPU was busy, and how many
+ * processes moved between CPUs, when there is more than one.
+ *
+ * @param e Pointer to the engine.
+ */
+void Engine_printCPUs(Engine* e) {
+  if (e->cpus == 1) {
+    return;
+  }
+  long long migrations = 0, steals = 0;
+  for (int c = 0; c < e->cpus; c++) {
+    Engine_CPU* cpu = &e->cpu[c];
+    printf("CPU %d: utilization = %.2f%%, migrations = %d, steals = %d\n", c,
+           e->lastEnd > 0 ? 100.0 * (double)cpu->busy / e->lastEnd : 0.0,
+           cpu->migrations, cpu->steals);
+    migrations += cpu->migrations;
+    steals += cpu->steals;
+  }
+  printf("Migrations = %lld, steals = %lld\n", migrations, steals);
+}
+
+/**
+ * @brief Returns the share of the CPU time spent running processes.
+ *
+ * @param e Pointer to the engine.
+ * @return The utilization of all the CPUs, in percent.
+ */
+double Engine_utilization(Engine* e) {
+  return e->lastEnd > 0
+             ? 100.0 * (double)e->totalRun / ((double)e->lastEnd * e->cpus)
+             : 0.0;
+}
+
+/**
+ * @brief Prints the totals of the finished processes.
+ *
+ * @param e Pointer to the engine.
+ */
+void Engine_printSummary(Engine* e) {
+  int n = e->finished > 0 ? e->finished : 1;
+  printf("Finished = %d, rejected = %d, last end time = %d\n", e->finished,
+         e->rejected, e->lastEnd);
+  printf("Avg WTA = %.2f, Avg Waiting = %.2f, CPU utilization = %.2f%%\n",
+         e->totalWeighted / n, (double)e->totalWait / n,
+         Engine_utilization(e));
+  Engine_printCPUs(e);
+}
+
+/**
+ * @brief Writes the percentiles of a histogram on one line of the report.
+ *
+ * @param out The report.
+ * @param name Name of the measure.
+ * @param h Pointer to the histogram.
+ */
+void Engine_writePercentiles(FILE* out, const char* name, Histogram* h) {
+  fprintf(out, "%s: p50 = %lld, p90 = %lld, p99 = %lld, p99.9 = %lld, "
+          "max = %lld\n", name, Histogram_percentile(h, 50),
+          Histogram_percentile(h, 90), Histogram_percentile(h, 99),
+          Histogram_percentile(h, 99.9), h->max);
+}
+
+/**
+ * @brief Writes the performance report of the run.
+ *
+ * The waiting and turnaround times of the finished processes were counted
+ * in histograms as they finished, so the report takes the same memory
+ * whatever the number of processes.
+ *
+ * @param e Pointer to the engine.
+ * @param name Path of the report.
+ */
+void Engine_writePerf(Engine* e, const char* name) {
+  FILE* out = fopen(name, "w");
+  if (out == NULL) {
+    perror("Error creating the performance report");
+    exit(-1);
+  }
+  int n = e->finished > 0 ? e->finished : 1;
+  fprintf(out, "CPU utilization = %.2f%%\n", Engine_utilization(e));
+  fprintf(out, "Avg WTA = %.2f\n", e->totalWeighted / n);
+  fprintf(out, "Std WTA = %.2f\n", sqrt(e->squaresWeighted / n));
+  fprintf(out, "Avg Waiting = %.2f\n", (double)e->totalWait / n);
+  Engine_writePercentiles(out, "Waiting", &e->waits);
+  Engine_writePercentiles(out, "Turnaround", &e->turnaround);
+  fprintf(out, "Finished = %d, rejected = %d, last end time = %d\n",
+          e->finished, e->rejected, e->lastEnd);
+  fclose(out);
+}
+
+#endif /* _ENGINE_H_ */
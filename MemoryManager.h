@@ -1,172 +1,778 @@
 /**
  * @file MemoryManager.h
  * @brief Header file for memory manager functions.
+ *
+ * The memory is managed by a binary buddy allocator over a pool whose size
+ * and minimum block size are chosen at runtime. The pool is an anonymous
+ * mapping reserved without committing memory, so pages are only backed once
+ * they are touched.
+ *
+ * The metadata grows with the number of blocks rather than with the pool
+ * size. Every block that currently exists (free, allocated or backing a slab)
+ * has one entry in an open-addressing hash table keyed by its offset, which
+ * gives the block starting at any offset in O(1). Free blocks of each order (a
+ * block of order k spans 2^k bytes) are also pushed onto a per-order stack;
+ * entries of blocks that were merged away stay there and are skipped when
+ * popped, and a stack is compacted once such stale entries outnumber the live
+ * ones.
+ *
+ * Requests smaller than the minimum block size are served by a slab layer:
+ * a minimum block is carved into up to 64 equal power-of-two slots, and the
+ * slabs of each size class that still have free slots are kept on a stack in
+ * the same lazy way as the free blocks.
  */
 
 #ifndef _MEMORY_MANAGER_H_
 #define _MEMORY_MANAGER_H_
 
-#include <math.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/mman.h>
 
-// Define the total memory size
+// Define the default memory sizes
 #define TOTAL_MEMORY_SIZE 1024
 #define MINIMUM_BLOCK_SIZE 8
+#define MAX_ORDERS 64      /**< Orders representable by a size_t */
+#define SLAB_MAX_ORDER 6   /**< A slab holds at most 2^6 = 64 slots */
+#define NO_UNIT UINT64_MAX /**< Returned when no block could be allocated */
+
+/**
+ * @brief State of a block in the block table.
+ */
+typedef enum BlockState {
+  _NO_BLOCK = 0,   /**< Empty table entry */
+  _FREE_BLOCK = 1, /**< A free block starts at this offset */
+  _USED_BLOCK = 2, /**< An allocated block starts at this offset */
+  _SLAB_BLOCK = 3  /**< A block carved into slab slots starts here */
+} BlockState;
 
-unsigned char arr[TOTAL_MEMORY_SIZE];  // NOLINT
+/**
+ * @brief Layout of a block table key: the block offset in units of the
+ * minimum block size, its order, its BlockState and a scratch mark bit.
+ */
+#define BLOCK_STATE_BITS 2
+#define BLOCK_MARK_BIT ((uint64_t)1 << BLOCK_STATE_BITS)
+#define BLOCK_ORDER_SHIFT (BLOCK_STATE_BITS + 1)
+#define BLOCK_UNIT_SHIFT (BLOCK_ORDER_SHIFT + 6)
 
-// Structure to represent a node in the binary tree
-typedef struct BuddyNode {
-  size_t size;
-  bool free;
-  struct BuddyNode* left;
-  struct BuddyNode* right;
-  size_t offset;
-} BuddyNode;
+/**
+ * @struct BlockEntry
+ * @brief Entry of the block table.
+ */
+typedef struct {
+  uint64_t key;   /**< Packed offset, order and state, 0 if empty */
+  uint64_t value; /**< Requested size of a used block, slab index of a slab */
+} BlockEntry;
+
+/**
+ * @struct IndexStack
+ * @brief Growable stack of block offsets or slab indices.
+ */
+typedef struct {
+  uint64_t* items; /**< Stacked values */
+  size_t size;     /**< Number of entries, stale ones included */
+  size_t capacity; /**< Allocated length of items */
+} IndexStack;
+
+/**
+ * @struct Slab
+ * @brief A minimum block carved into equal slots of one size class.
+ */
+typedef struct {
+  uint64_t unit;          /**< Offset of the block in minimum block units */
+  uint64_t used;          /**< Bit i set if slot i is allocated */
+  int order;              /**< Order of the slots, -1 if the slab is unused */
+  bool marked;            /**< Scratch flag used while compacting */
+  uint32_t requested[1 << SLAB_MAX_ORDER]; /**< Requested size per slot */
+} Slab;
+
+/**
+ * @struct MemoryStats
+ * @brief Occupancy and fragmentation counters of the allocator.
+ */
+typedef struct {
+  size_t totalSize;             /**< Size of the pool */
+  size_t freeBytes;             /**< Bytes in free buddy blocks */
+  size_t freeSlotBytes;         /**< Bytes in free slots of partial slabs */
+  size_t largestFreeBlock;      /**< Size of the largest free buddy block */
+  size_t requestedBytes;        /**< Bytes asked for by live allocations */
+  size_t allocatedBytes;        /**< Bytes of the blocks and slots handed out */
+  size_t slabBytes;             /**< Bytes of the blocks backing slabs */
+  size_t usedBlocks;            /**< Live buddy allocations */
+  size_t usedSlots;             /**< Live slab allocations */
+  size_t internalFragmentation; /**< Handed out but not requested */
+  double externalFragmentation; /**< 1 - largestFreeBlock / freeBytes */
+} MemoryStats;
 
 /**
  * @struct BuddyAllocator
  * @brief Structure to represent the buddy allocator.
  */
 typedef struct {
-  BuddyNode* root;
+  unsigned char* base;             /**< Start of the simulated memory */
+  size_t totalSize;                /**< Size of the pool, a power of two */
+  int minOrder;                    /**< Order of the minimum block size */
+  int maxOrder;                    /**< Order of the whole pool */
+  int slabOrder;                   /**< Order of the smallest slab slots */
+  BlockEntry* table;               /**< Hash table of blocks */
+  size_t tableCapacity;            /**< Length of table, a power of two */
+  size_t tableSize;                /**< Number of used table entries */
+  IndexStack freeList[MAX_ORDERS]; /**< Free blocks of each order */
+  size_t freeCount[MAX_ORDERS];    /**< Live free blocks of each order */
+  uint64_t nonEmpty;               /**< Bit k set if freeCount[k] > 0 */
+  Slab* slabs;                     /**< Slab descriptors */
+  size_t slabsNum;                 /**< Number of descriptors in use */
+  size_t slabsCapacity;            /**< Allocated length of slabs */
+  IndexStack unusedSlabs;          /**< Released descriptors to reuse */
+  IndexStack partial[MAX_ORDERS];  /**< Slabs of each order with free slots */
+  size_t partialCount[MAX_ORDERS]; /**< Live slabs with free slots */
+  size_t freeSlots[MAX_ORDERS];    /**< Free slots of each order */
+  size_t requestedBytes;           /**< Bytes asked for by live allocations */
+  size_t allocatedBytes;           /**< Bytes of blocks and slots handed out */
+  size_t slabBytes;                /**< Bytes of the blocks backing slabs */
+  size_t usedBlocks;               /**< Live buddy allocations */
+  size_t usedSlots;                /**< Live slab allocations */
 } BuddyAllocator;
 
 /**
  * @brief Global instance of the buddy allocator.
  */
-BuddyAllocator globalAllocator = {.root = NULL};  // NOLINT
+BuddyAllocator globalAllocator;  // NOLINT
 
 /**
- * @brief Creates a new BuddyNode.
+ * @brief Rounds a size up to the order of the smallest block holding it.
  *
- * @param size The size of the memory block represented by this node.
- * @param parent Pointer to the parent node.
- * @param offset Offset of the memory block represented by this node.
- * @return Pointer to the newly created BuddyNode.
+ * @param size The requested size.
+ * @return The order k such that 2^k is the smallest power of two >= size.
  */
-BuddyNode* createBuddyNode(size_t size, size_t offset) {
-  BuddyNode* node = (BuddyNode*)malloc(sizeof(BuddyNode));
-  node->size = size;
-  node->free = true;
-  node->left = NULL;
-  node->right = NULL;
-  node->offset = offset;
-  return node;
+int sizeToOrder(size_t size) {
+  if (size <= 1) {
+    return 0;
+  }
+  return (int)(sizeof(unsigned long) * 8) - __builtin_clzl(size - 1);
 }
 
 /**
- * @brief Initializes the buddy allocator.
+ * @brief Packs a block table key.
+ */
+uint64_t makeBlockKey(uint64_t unit, int order, BlockState state) {
+  return (unit << BLOCK_UNIT_SHIFT) | ((uint64_t)order << BLOCK_ORDER_SHIFT) |
+         (uint64_t)state;
+}
+
+/**
+ * @brief Unpacks the offset (in minimum block units) of a table key.
  */
-void initializeBuddyAllocator(void) {
-  globalAllocator.root = createBuddyNode(TOTAL_MEMORY_SIZE, 0);
+uint64_t blockKeyUnit(uint64_t key) { return key >> BLOCK_UNIT_SHIFT; }
+
+/**
+ * @brief Unpacks the order of a table key.
+ */
+int blockKeyOrder(uint64_t key) {
+  return (int)((key >> BLOCK_ORDER_SHIFT) & 63);
+}
+
+/**
+ * @brief Unpacks the BlockState of a table key.
+ */
+BlockState blockKeyState(uint64_t key) {
+  return (BlockState)(key & ((1 << BLOCK_STATE_BITS) - 1));
 }
 
 /**
- * @brief Splits a node into two buddies.
+ * @brief Returns the home slot of a block in the table.
+ */
+size_t blockHash(uint64_t unit) {
+  return (size_t)((unit * 0x9E3779B97F4A7C15ULL) >> 17) &
+         (globalAllocator.tableCapacity - 1);
+}
+
+/**
+ * @brief Finds the table slot of a block, or the empty slot it would use.
  *
- * @param node Pointer to the node to split.
+ * @param unit Offset of the block in minimum block units.
+ * @return Index of the slot.
  */
-void splitNode(BuddyNode* node) {
-  size_t newSize = node->size / 2;
-  node->left = createBuddyNode(newSize, node->offset);
-  node->right = createBuddyNode(newSize, node->offset + newSize);
-  node->free = true;
+size_t findBlockSlot(uint64_t unit) {
+  size_t mask = globalAllocator.tableCapacity - 1;
+  size_t i = blockHash(unit);
+  while (globalAllocator.table[i].key != 0 &&
+         blockKeyUnit(globalAllocator.table[i].key) != unit) {
+    i = (i + 1) & mask;
+  }
+  return i;
 }
 
 /**
- * @brief Finds and allocates memory.
+ * @brief Looks a block up in the table.
  *
- * @param node Pointer to the node to start allocation from.
- * @param size The size of memory to allocate.
- * @return Pointer to the allocated memory block, or NULL if allocation fails.
- */
-void* allocateMemory(BuddyNode* node, size_t size) {
-  if (node->size == size && node->free && !(node->right) &&  // NOLINT
-      !(node->left)) {                                       // NOLINT
-    node->free = false;
-    return (void*)&arr[node->offset];
-  } else if (node->size < size || !(node->free)) {
-    return NULL;
-  } else {
-    if (node->left == NULL && node->right == NULL) {
-      splitNode(node);
+ * @param unit Offset of the block in minimum block units.
+ * @return Pointer to its entry, or NULL if no block starts there.
+ */
+BlockEntry* lookupBlock(uint64_t unit) {
+  size_t i = findBlockSlot(unit);
+  return globalAllocator.table[i].key == 0 ? NULL : &globalAllocator.table[i];
+}
+
+/**
+ * @brief Doubles the table, reinserting every entry.
+ */
+void growBlockTable(void) {
+  BlockEntry* oldTable = globalAllocator.table;
+  size_t oldCapacity = globalAllocator.tableCapacity;
+  size_t newCapacity = oldCapacity * 2;
+  globalAllocator.table = (BlockEntry*)calloc(newCapacity, sizeof(BlockEntry));
+  if (globalAllocator.table == NULL) {
+    perror("Memory allocation failed");
+    exit(-1);
+  }
+  globalAllocator.tableCapacity = newCapacity;
+  for (size_t i = 0; i < oldCapacity; i++) {
+    if (oldTable[i].key != 0) {
+      globalAllocator.table[findBlockSlot(blockKeyUnit(oldTable[i].key))] =
+          oldTable[i];
     }
-    void* left_result = allocateMemory(node->left, size);
-    if (left_result != NULL) {
-      return left_result;
-    } else {
-      return allocateMemory(node->right, size);
+  }
+  free(oldTable);
+}
+
+/**
+ * @brief Inserts or overwrites the entry of a block.
+ *
+ * @param unit Offset of the block in minimum block units.
+ * @param order Order of the block.
+ * @param state State of the block.
+ * @param value Value stored along with the block.
+ */
+void setBlock(uint64_t unit, int order, BlockState state, uint64_t value) {
+  size_t i = findBlockSlot(unit);
+  if (globalAllocator.table[i].key == 0) {
+    // Keep the load factor under 3/4
+    if (4 * (globalAllocator.tableSize + 1) >
+        3 * globalAllocator.tableCapacity) {
+      growBlockTable();
+      i = findBlockSlot(unit);
     }
+    globalAllocator.tableSize++;
   }
+  globalAllocator.table[i].key = makeBlockKey(unit, order, state);
+  globalAllocator.table[i].value = value;
 }
 
 /**
- * @brief Merges free blocks in the binary tree.
+ * @brief Removes the entry of a block, shifting back the entries that
+ * probed past it so no tombstones are left.
  *
- * @param node Pointer to the root node of the subtree to merge.
+ * @param unit Offset of the block in minimum block units.
  */
-void mergeFreeBlocks(BuddyNode* node) {
-  if (node == NULL || node->left == NULL || node->right == NULL) {
+void removeBlock(uint64_t unit) {
+  size_t mask = globalAllocator.tableCapacity - 1;
+  size_t i = findBlockSlot(unit);
+  if (globalAllocator.table[i].key == 0) {
     return;
   }
-  // Recursively merge free blocks in the left and right subtrees
-  mergeFreeBlocks(node->left);
-  mergeFreeBlocks(node->right);
-  // Merge adjacent free blocks
-  if (node->left->free && node->right->free) {
-    if (node->left->left == NULL && node->right->left == NULL) {
-      node->free = true;
-      free(node->left);
-      free(node->right);
-      node->left = NULL;
-      node->right = NULL;
+  globalAllocator.tableSize--;
+  size_t j = i;
+  while (true) {
+    globalAllocator.table[i].key = 0;
+    BlockEntry entry;
+    size_t home;
+    do {
+      j = (j + 1) & mask;
+      entry = globalAllocator.table[j];
+      if (entry.key == 0) {
+        return;
+      }
+      home = blockHash(blockKeyUnit(entry.key));
+      // Leave the entry where it is if its home lies cyclically in (i, j]
+    } while (i <= j ? (i < home && home <= j) : (i < home || home <= j));
+    globalAllocator.table[i] = entry;
+    i = j;
+  }
+}
+
+/**
+ * @brief Pushes a value onto a stack.
+ *
+ * @param stack Pointer to the stack.
+ * @param item Value to be pushed.
+ */
+void pushIndex(IndexStack* stack, uint64_t item) {
+  if (stack->size == stack->capacity) {
+    size_t newCapacity = stack->capacity == 0 ? 16 : stack->capacity * 2;
+    uint64_t* items = (uint64_t*)realloc(
+        stack->items, newCapacity * sizeof(uint64_t));  // NOLINT
+    if (items == NULL) {
+      perror("Memory allocation failed");
+      exit(-1);
     }
+    stack->items = items;
+    stack->capacity = newCapacity;
   }
+  stack->items[stack->size++] = item;
 }
 
 /**
- * @brief Finds the BuddyNode corresponding to a memory block.
+ * @brief Checks if a block is a live free block of the given order.
  *
- * @param node Pointer to the root node of the subtree to search.
- * @param block Pointer to the memory block to find.
- * @return Pointer to the BuddyNode corresponding to the memory block, or NULL
- * if not found.
+ * @param unit Offset of the block in minimum block units.
+ * @param order Order of the block.
+ * @return true if it is, false otherwise.
  */
-BuddyNode* findBuddyNode(BuddyNode* node, void* block) {
-  if (node == NULL) {
-    return NULL;
+bool isFreeBlock(uint64_t unit, int order) {
+  BlockEntry* entry = lookupBlock(unit);
+  return (bool)(entry != NULL && blockKeyState(entry->key) == _FREE_BLOCK &&
+                blockKeyOrder(entry->key) == order);
+}
+
+/**
+ * @brief Drops stale and duplicate entries from the free stack of an order.
+ *
+ * @param order Order of the stack.
+ */
+void compactFreeStack(int order) {
+  IndexStack* stack = &globalAllocator.freeList[order];
+  size_t kept = 0;
+  for (size_t i = 0; i < stack->size; i++) {
+    BlockEntry* entry = lookupBlock(stack->items[i]);
+    if (entry != NULL && blockKeyState(entry->key) == _FREE_BLOCK &&
+        blockKeyOrder(entry->key) == order &&
+        !(entry->key & BLOCK_MARK_BIT)) {
+      entry->key |= BLOCK_MARK_BIT;
+      stack->items[kept++] = stack->items[i];
+    }
   }
-  if ((void*)&arr[node->offset] == block && !(node->left) && !(node->right)) {
-    return node;
+  stack->size = kept;
+  for (size_t i = 0; i < kept; i++) {
+    lookupBlock(stack->items[i])->key &= ~BLOCK_MARK_BIT;
   }
-  BuddyNode* left_result = findBuddyNode(node->left, block);
-  if (left_result != NULL) {
-    return left_result;
+}
+
+/**
+ * @brief Records a free block and pushes it onto the stack of its order.
+ *
+ * @param unit Offset of the block in minimum block units.
+ * @param order Order of the block.
+ */
+void pushFreeBlock(uint64_t unit, int order) {
+  IndexStack* stack = &globalAllocator.freeList[order];
+  setBlock(unit, order, _FREE_BLOCK, 0);
+  if (stack->size == stack->capacity &&
+      stack->size > 2 * globalAllocator.freeCount[order] + 64) {
+    compactFreeStack(order);
   }
-  return findBuddyNode(node->right, block);
+  pushIndex(stack, unit);
+  globalAllocator.freeCount[order]++;
+  globalAllocator.nonEmpty |= (uint64_t)1 << order;
 }
 
 /**
- * @brief Prints the memory layout.
+ * @brief Forgets a free block, leaving its stack entry to be skipped.
  *
- * @param node Pointer to the root node of the binary tree to print.
+ * @param unit Offset of the block in minimum block units.
+ * @param order Order of the block.
  */
-void printMemoryLayout(BuddyNode* node) {
-  if (node == NULL) {
-    return;
+void unlinkFreeBlock(uint64_t unit, int order) {
+  removeBlock(unit);
+  if (--globalAllocator.freeCount[order] == 0) {
+    globalAllocator.nonEmpty &= ~((uint64_t)1 << order);
+  }
+}
+
+/**
+ * @brief Pops a live free block of an order, skipping stale entries.
+ *
+ * @param order Order of the block; its free count must be non-zero.
+ * @return Offset of the block in minimum block units.
+ */
+uint64_t popFreeBlock(int order) {
+  IndexStack* stack = &globalAllocator.freeList[order];
+  uint64_t unit;
+  do {
+    unit = stack->items[--stack->size];
+  } while (!isFreeBlock(unit, order));
+  unlinkFreeBlock(unit, order);
+  return unit;
+}
+
+/**
+ * @brief Takes a block of the given order out of the free lists, splitting
+ * a larger one if needed. The caller records the block in the table.
+ *
+ * @param order Order of the block.
+ * @return Offset of the block in minimum block units, or NO_UNIT.
+ */
+uint64_t takeBlock(int order) {
+  // Take the smallest free block that is large enough
+  uint64_t candidates = globalAllocator.nonEmpty >> order;
+  if (candidates == 0) {
+    return NO_UNIT;
   }
-  if (node->left == NULL && node->right == NULL) {
-    if (!node->free) {
-      printf("[%zu:Allocated] ", node->size);
-    } else {
-      printf("[%zu:Free] ", node->size);
+  int k = order + __builtin_ctzll(candidates);
+  uint64_t unit = popFreeBlock(k);
+  // Split it, handing the upper halves back to the free lists
+  while (k > order) {
+    k--;
+    pushFreeBlock(unit + ((uint64_t)1 << (k - globalAllocator.minOrder)), k);
+  }
+  return unit;
+}
+
+/**
+ * @brief Returns a block to the free lists, merging it with its buddies.
+ *
+ * @param unit Offset of the block in minimum block units.
+ * @param order Order of the block.
+ */
+void releaseBlock(uint64_t unit, int order) {
+  removeBlock(unit);
+  // Merge with the buddy as long as it is a free block of the same order
+  while (order < globalAllocator.maxOrder) {
+    uint64_t bit = (uint64_t)1 << (order - globalAllocator.minOrder);
+    if (!isFreeBlock(unit ^ bit, order)) {
+      break;
+    }
+    unlinkFreeBlock(unit ^ bit, order);
+    unit &= ~bit;
+    order++;
+  }
+  pushFreeBlock(unit, order);
+}
+
+/**
+ * @brief Returns the bitmask covering every slot of a slab of an order.
+ */
+uint64_t slabFullMask(int order) {
+  int slots = 1 << (globalAllocator.minOrder - order);
+  return slots == 64 ? ~(uint64_t)0 : ((uint64_t)1 << slots) - 1;
+}
+
+/**
+ * @brief Checks if a stacked slab index is a live slab of an order with at
+ * least one free slot.
+ */
+bool isPartialSlab(uint64_t index, int order) {
+  Slab* slab = &globalAllocator.slabs[index];
+  return (bool)(slab->order == order && slab->used != slabFullMask(order));
+}
+
+/**
+ * @brief Drops stale and duplicate entries from the partial stack of an
+ * order.
+ *
+ * @param order Order of the slots.
+ */
+void compactPartialStack(int order) {
+  IndexStack* stack = &globalAllocator.partial[order];
+  size_t kept = 0;
+  for (size_t i = 0; i < stack->size; i++) {
+    uint64_t index = stack->items[i];
+    if (isPartialSlab(index, order) && !globalAllocator.slabs[index].marked) {
+      globalAllocator.slabs[index].marked = true;
+      stack->items[kept++] = index;
     }
+  }
+  stack->size = kept;
+  for (size_t i = 0; i < kept; i++) {
+    globalAllocator.slabs[stack->items[i]].marked = false;
+  }
+}
+
+/**
+ * @brief Pushes a slab onto the partial stack of its order.
+ *
+ * @param index Index of the slab.
+ */
+void pushPartialSlab(uint64_t index) {
+  int order = globalAllocator.slabs[index].order;
+  IndexStack* stack = &globalAllocator.partial[order];
+  if (stack->size == stack->capacity &&
+      stack->size > 2 * globalAllocator.partialCount[order] + 64) {
+    compactPartialStack(order);
+  }
+  pushIndex(stack, index);
+  globalAllocator.partialCount[order]++;
+}
+
+/**
+ * @brief Carves a new slab for an order out of a minimum block.
+ *
+ * @param order Order of the slots.
+ * @return Index of the slab, or NO_UNIT if no block is free.
+ */
+uint64_t createSlab(int order) {
+  uint64_t unit = takeBlock(globalAllocator.minOrder);
+  if (unit == NO_UNIT) {
+    return NO_UNIT;
+  }
+  uint64_t index;
+  if (globalAllocator.unusedSlabs.size > 0) {
+    index = globalAllocator.unusedSlabs.items[--globalAllocator.unusedSlabs
+                                                   .size];
   } else {
-    printMemoryLayout(node->left);
-    printMemoryLayout(node->right);
+    if (globalAllocator.slabsNum == globalAllocator.slabsCapacity) {
+      size_t newCapacity = globalAllocator.slabsCapacity == 0
+                               ? 16
+                               : globalAllocator.slabsCapacity * 2;
+      Slab* slabs = (Slab*)realloc(globalAllocator.slabs,
+                                   newCapacity * sizeof(Slab));  // NOLINT
+      if (slabs == NULL) {
+        perror("Memory allocation failed");
+        exit(-1);
+      }
+      globalAllocator.slabs = slabs;
+      globalAllocator.slabsCapacity = newCapacity;
+    }
+    index = globalAllocator.slabsNum++;
+  }
+  Slab* slab = &globalAllocator.slabs[index];
+  slab->unit = unit;
+  slab->used = 0;
+  slab->order = order;
+  slab->marked = false;
+  setBlock(unit, globalAllocator.minOrder, _SLAB_BLOCK, index);
+  globalAllocator.slabBytes += (size_t)1 << globalAllocator.minOrder;
+  globalAllocator.freeSlots[order] += 1 << (globalAllocator.minOrder - order);
+  pushPartialSlab(index);
+  return index;
+}
+
+/**
+ * @brief Allocates a slot of an order from the slab layer.
+ *
+ * @param order Order of the slot.
+ * @param size The requested size.
+ * @return Pointer to the slot, or NULL if allocation fails.
+ */
+void* allocateSlot(int order, size_t size) {
+  IndexStack* stack = &globalAllocator.partial[order];
+  // Drop stale entries off the top of the stack
+  while (stack->size > 0 &&
+         !isPartialSlab(stack->items[stack->size - 1], order)) {
+    stack->size--;
+  }
+  uint64_t index = stack->size > 0 ? stack->items[stack->size - 1]
+                                   : createSlab(order);
+  if (index == NO_UNIT) {
+    return NULL;
+  }
+  Slab* slab = &globalAllocator.slabs[index];
+  int slot = __builtin_ctzll(~slab->used);
+  slab->used |= (uint64_t)1 << slot;
+  slab->requested[slot] = (uint32_t)size;
+  if (slab->used == slabFullMask(order)) {
+    stack->size--;
+    globalAllocator.partialCount[order]--;
+  }
+  globalAllocator.freeSlots[order]--;
+  globalAllocator.usedSlots++;
+  globalAllocator.requestedBytes += size;
+  globalAllocator.allocatedBytes += (size_t)1 << order;
+  return (void*)(globalAllocator.base +
+                 (slab->unit << globalAllocator.minOrder) +
+                 ((size_t)slot << order));
+}
+
+/**
+ * @brief Frees a slot of a slab, releasing the slab once it is empty.
+ *
+ * @param index Index of the slab.
+ * @param slot Index of the slot in the slab.
+ */
+void deallocateSlot(uint64_t index, int slot) {
+  Slab* slab = &globalAllocator.slabs[index];
+  int order = slab->order;
+  bool wasFull = (bool)(slab->used == slabFullMask(order));
+  slab->used &= ~((uint64_t)1 << slot);
+  globalAllocator.freeSlots[order]++;
+  globalAllocator.usedSlots--;
+  globalAllocator.requestedBytes -= slab->requested[slot];
+  globalAllocator.allocatedBytes -= (size_t)1 << order;
+  if (slab->used == 0) {
+    // Hand the block back to the buddy allocator
+    if (!wasFull) {
+      globalAllocator.partialCount[order]--;
+    }
+    globalAllocator.freeSlots[order] -= 1 << (globalAllocator.minOrder - order);
+    globalAllocator.slabBytes -= (size_t)1 << globalAllocator.minOrder;
+    slab->order = -1;
+    pushIndex(&globalAllocator.unusedSlabs, index);
+    releaseBlock(slab->unit, globalAllocator.minOrder);
+  } else if (wasFull) {
+    pushPartialSlab(index);
+  }
+}
+
+/**
+ * @brief Parses a size given in bytes, optionally followed by a binary
+ * suffix (K, M, G or T).
+ *
+ * @param text The text to be parsed.
+ * @return The size in bytes.
+ */
+size_t parseSize(const char* text) {
+  char* end;
+  size_t size = (size_t)strtoull(text, &end, 10);
+  switch (*end) {
+    case 'T':
+      size <<= 10;
+      /* fall through */
+    case 'G':
+      size <<= 10;
+      /* fall through */
+    case 'M':
+      size <<= 10;
+      /* fall through */
+    case 'K':
+      size <<= 10;
+      end++;
+      break;
+    default:
+      break;
+  }
+  if (end == text || *end != '\0' || size == 0) {
+    fprintf(stderr, "Invalid size: %s\n", text);
+    exit(-1);
+  }
+  return size;
+}
+
+/**
+ * @brief Initializes the buddy allocator.
+ *
+ * @param totalSize Size of the pool, rounded up to a power of two.
+ * @param minBlockSize Size of the smallest block, rounded up to a power of
+ * two.
+ */
+void initializeBuddyAllocator(size_t totalSize, size_t minBlockSize) {
+  globalAllocator.maxOrder = sizeToOrder(totalSize);
+  globalAllocator.minOrder = sizeToOrder(minBlockSize);
+  if (globalAllocator.maxOrder >= MAX_ORDERS - 1 ||
+      globalAllocator.minOrder > globalAllocator.maxOrder) {
+    fprintf(stderr, "Invalid memory size %zu with minimum block %zu\n",
+            totalSize, minBlockSize);
+    exit(-1);
+  }
+  globalAllocator.slabOrder = globalAllocator.minOrder - SLAB_MAX_ORDER;
+  if (globalAllocator.slabOrder < 0) {
+    globalAllocator.slabOrder = 0;
+  }
+  globalAllocator.totalSize = (size_t)1 << globalAllocator.maxOrder;
+  // Reserve the pool without committing it
+  void* base = mmap(NULL, globalAllocator.totalSize, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED) {
+    perror("Error in mapping the memory pool");
+    exit(-1);
+  }
+  globalAllocator.base = (unsigned char*)base;
+  globalAllocator.tableCapacity = 1024;
+  globalAllocator.tableSize = 0;
+  globalAllocator.table =
+      (BlockEntry*)calloc(globalAllocator.tableCapacity, sizeof(BlockEntry));
+  if (globalAllocator.table == NULL) {
+    perror("Memory allocation failed");
+    exit(-1);
+  }
+  for (int k = 0; k < MAX_ORDERS; k++) {
+    globalAllocator.freeList[k] = (IndexStack){NULL, 0, 0};
+    globalAllocator.freeCount[k] = 0;
+    globalAllocator.partial[k] = (IndexStack){NULL, 0, 0};
+    globalAllocator.partialCount[k] = 0;
+    globalAllocator.freeSlots[k] = 0;
+  }
+  globalAllocator.nonEmpty = 0;
+  globalAllocator.slabs = NULL;
+  globalAllocator.slabsNum = 0;
+  globalAllocator.slabsCapacity = 0;
+  globalAllocator.unusedSlabs = (IndexStack){NULL, 0, 0};
+  globalAllocator.requestedBytes = 0;
+  globalAllocator.allocatedBytes = 0;
+  globalAllocator.slabBytes = 0;
+  globalAllocator.usedBlocks = 0;
+  globalAllocator.usedSlots = 0;
+  pushFreeBlock(0, globalAllocator.maxOrder);
+}
+
+/**
+ * @brief Releases the pool and the bookkeeping of the buddy allocator, which
+ * can then be initialized again.
+ */
+void destroyBuddyAllocator(void) {
+  munmap(globalAllocator.base, globalAllocator.totalSize);
+  free(globalAllocator.table);
+  for (int k = 0; k < MAX_ORDERS; k++) {
+    free(globalAllocator.freeList[k].items);
+    free(globalAllocator.partial[k].items);
+  }
+  free(globalAllocator.slabs);
+  free(globalAllocator.unusedSlabs.items);
+  memset(&globalAllocator, 0, sizeof(globalAllocator));
+}
+
+/**
+ * @brief Finds the table entry of the block a pointer lies in.
+ *
+ * @param block Pointer returned by allocate.
+ * @return Pointer to the entry of a used or slab block, or NULL if block
+ * does not lie in one.
+ */
+BlockEntry* findBlock(void* block) {
+  if (block == NULL) {
+    return NULL;
+  }
+  unsigned char* address = (unsigned char*)block;
+  if (address < globalAllocator.base ||
+      address >= globalAllocator.base + globalAllocator.totalSize) {
+    return NULL;
+  }
+  size_t offset = (size_t)(address - globalAllocator.base);
+  BlockEntry* entry = lookupBlock(offset >> globalAllocator.minOrder);
+  if (entry == NULL) {
+    return NULL;
+  }
+  size_t inBlock = offset & (((size_t)1 << globalAllocator.minOrder) - 1);
+  BlockState state = blockKeyState(entry->key);
+  if (state == _USED_BLOCK && inBlock == 0) {
+    return entry;
+  }
+  if (state == _SLAB_BLOCK) {
+    Slab* slab = &globalAllocator.slabs[entry->value];
+    size_t slot = inBlock >> slab->order;
+    if ((inBlock & (((size_t)1 << slab->order) - 1)) == 0 &&
+        (slab->used & ((uint64_t)1 << slot))) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Prints the memory layout.
+ */
+void printMemoryLayout(void) {
+  uint64_t unit = 0;
+  uint64_t units = (uint64_t)1
+                   << (globalAllocator.maxOrder - globalAllocator.minOrder);
+  while (unit < units) {
+    BlockEntry* entry = lookupBlock(unit);
+    int order = blockKeyOrder(entry->key);
+    switch (blockKeyState(entry->key)) {
+      case _USED_BLOCK:
+        printf("[%zu:Allocated] ", (size_t)1 << order);
+        break;
+      case _SLAB_BLOCK:
+        printf("[%zu:Slab of %zu] ", (size_t)1 << order,
+               (size_t)1 << globalAllocator.slabs[entry->value].order);
+        break;
+      default:
+        printf("[%zu:Free] ", (size_t)1 << order);
+        break;
+    }
+    unit += (uint64_t)1 << (order - globalAllocator.minOrder);
   }
 }
 
@@ -178,6 +784,64 @@ void printMemoryLayout(BuddyNode* node) {
  * memory structure.
  */
 
+/**
+ * @brief Allocates memory of the specified size, without timing it.
+ *
+ * Sizes below the minimum block size are served from a slab; a request for 0
+ * bytes is served like a request for 1 byte.
+ *
+ * @param size The size of memory to allocate.
+ * @return A pointer to the allocated memory block, or NULL if allocation fails.
+ */
+void* allocateMemory(size_t size) {
+  if (size > globalAllocator.totalSize) {
+    return NULL;
+  }
+  if (size == 0) {
+    size = 1;
+  }
+  int order = sizeToOrder(size);
+  if (order < globalAllocator.minOrder) {
+    if (order < globalAllocator.slabOrder) {
+      order = globalAllocator.slabOrder;
+    }
+    return allocateSlot(order, size);
+  }
+  uint64_t unit = takeBlock(order);
+  if (unit == NO_UNIT) {
+    return NULL;
+  }
+  setBlock(unit, order, _USED_BLOCK, size);
+  globalAllocator.usedBlocks++;
+  globalAllocator.requestedBytes += size;
+  globalAllocator.allocatedBytes += (size_t)1 << order;
+  return (void*)(globalAllocator.base + (unit << globalAllocator.minOrder));
+}
+
+/**
+ * @brief Deallocates memory previously allocated, without timing it.
+ *
+ * @param block Pointer to the memory block to deallocate.
+ */
+void deallocateMemory(void* block) {
+  BlockEntry* entry = findBlock(block);
+  if (entry == NULL) {
+    return;
+  }
+  if (blockKeyState(entry->key) == _SLAB_BLOCK) {
+    Slab* slab = &globalAllocator.slabs[entry->value];
+    size_t inBlock = (size_t)((unsigned char*)block - globalAllocator.base) &
+                     (((size_t)1 << globalAllocator.minOrder) - 1);
+    deallocateSlot(entry->value, (int)(inBlock >> slab->order));
+    return;
+  }
+  int order = blockKeyOrder(entry->key);
+  globalAllocator.usedBlocks--;
+  globalAllocator.requestedBytes -= entry->value;
+  globalAllocator.allocatedBytes -= (size_t)1 << order;
+  releaseBlock(blockKeyUnit(entry->key), order);
+}
+
 /**
  * @brief Allocates memory of the specified size.
  *
@@ -185,8 +849,10 @@ void printMemoryLayout(BuddyNode* node) {
  * @return A pointer to the allocated memory block, or NULL if allocation fails.
  */
 void* allocate(size_t size) {
-  size_t rounded_size = (size_t)pow(2, ceil(log2(size)));  // NOLINT
-  return allocateMemory(globalAllocator.root, rounded_size);
+  PROBE_BEGIN(begin);
+  void* block = allocateMemory(size);
+  PROBE_END(_PROBE_ALLOCATE, begin);
+  return block;
 }
 
 /**
@@ -195,11 +861,9 @@ void* allocate(size_t size) {
  * @param block Pointer to the memory block to deallocate.
  */
 void deallocate(void* block) {
-  BuddyNode* node = findBuddyNode(globalAllocator.root, block);
-  if (node != NULL) {
-    node->free = true;
-    mergeFreeBlocks(globalAllocator.root);
-  }
+  PROBE_BEGIN(begin);
+  deallocateMemory(block);
+  PROBE_END(_PROBE_DEALLOCATE, begin);
 }
 
 /**
@@ -209,8 +873,7 @@ void deallocate(void* block) {
  * @return The starting address of the memory block.
  */
 size_t getStartAddress(void* block) {
-  BuddyNode* node = findBuddyNode(globalAllocator.root, block);
-  return node->offset;
+  return (size_t)((unsigned char*)block - globalAllocator.base);
 }
 
 /**
@@ -220,15 +883,95 @@ size_t getStartAddress(void* block) {
  * @return The ending address of the memory block.
  */
 size_t getEndAddress(void* block) {
-  BuddyNode* node = findBuddyNode(globalAllocator.root, block);
-  return (node->offset + node->size - 1);
+  BlockEntry* entry = findBlock(block);
+  size_t size = 1;
+  if (entry != NULL && blockKeyState(entry->key) == _SLAB_BLOCK) {
+    size = (size_t)1 << globalAllocator.slabs[entry->value].order;
+  } else if (entry != NULL) {
+    size = (size_t)1 << blockKeyOrder(entry->key);
+  }
+  return getStartAddress(block) + size - 1;
+}
+
+/**
+ * @brief Counts how many more allocations of a size would currently succeed.
+ *
+ * @param size The size of each allocation.
+ * @return The number of allocations that fit in the free memory.
+ */
+size_t countFittingAllocations(size_t size) {
+  if (size > globalAllocator.totalSize) {
+    return 0;
+  }
+  int order = sizeToOrder(size == 0 ? 1 : size);
+  size_t count = 0;
+  if (order < globalAllocator.minOrder) {
+    if (order < globalAllocator.slabOrder) {
+      order = globalAllocator.slabOrder;
+    }
+    count = globalAllocator.freeSlots[order];
+  }
+  int blockOrder =
+      order < globalAllocator.minOrder ? globalAllocator.minOrder : order;
+  for (int k = blockOrder; k <= globalAllocator.maxOrder; k++) {
+    count += globalAllocator.freeCount[k] << (k - order);
+  }
+  return count;
+}
+
+/**
+ * @brief Collects the occupancy and fragmentation counters.
+ *
+ * @return The current memory statistics.
+ */
+MemoryStats getMemoryStats(void) {
+  MemoryStats stats;
+  stats.totalSize = globalAllocator.totalSize;
+  stats.freeBytes = 0;
+  for (int k = globalAllocator.minOrder; k <= globalAllocator.maxOrder; k++) {
+    stats.freeBytes += globalAllocator.freeCount[k] << k;
+  }
+  stats.freeSlotBytes = 0;
+  for (int k = globalAllocator.slabOrder; k < globalAllocator.minOrder; k++) {
+    stats.freeSlotBytes += globalAllocator.freeSlots[k] << k;
+  }
+  stats.largestFreeBlock =
+      globalAllocator.nonEmpty == 0
+          ? 0
+          : (size_t)1 << (63 - __builtin_clzll(globalAllocator.nonEmpty));
+  stats.requestedBytes = globalAllocator.requestedBytes;
+  stats.allocatedBytes = globalAllocator.allocatedBytes;
+  stats.slabBytes = globalAllocator.slabBytes;
+  stats.usedBlocks = globalAllocator.usedBlocks;
+  stats.usedSlots = globalAllocator.usedSlots;
+  stats.internalFragmentation = stats.allocatedBytes - stats.requestedBytes;
+  stats.externalFragmentation =
+      stats.freeBytes == 0
+          ? 0.0
+          : 1.0 - (double)stats.largestFreeBlock / (double)stats.freeBytes;
+  return stats;
+}
+
+/**
+ * @brief Prints the memory statistics.
+ */
+void printMemoryStats(void) {
+  MemoryStats stats = getMemoryStats();
+  printf("Memory: %zu/%zu bytes free, largest free block = %zu\n",
+         stats.freeBytes, stats.totalSize, stats.largestFreeBlock);
+  printf("Memory: %zu more bytes free in the slots of partial slabs\n",
+         stats.freeSlotBytes);
+  printf("Memory: %zu blocks and %zu slab slots in use, %zu bytes requested\n",
+         stats.usedBlocks, stats.usedSlots, stats.requestedBytes);
+  printf("Memory: internal fragmentation = %zu bytes, external = %.2f%%\n",
+         stats.internalFragmentation, 100.0 * stats.externalFragmentation);
 }
 
 /**
  * @brief Prints the memory structure.
  */
 void printMemoryStructure(void) {
-  printMemoryLayout(globalAllocator.root);
+  printMemoryLayout();
   printf("\n");
 }
 
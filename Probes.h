@@ -0,0 +1,103 @@
+/**
+ * @file Probes.h
+ * @brief Latency probes of the scheduler, compiled in with -DSCHED_PROBES
+ * (make build PROBES=1).
+ *
+ * A probe reads CLOCK_MONOTONIC before and after an operation and counts the
+ * time it took in the histogram of the operation, so the cost of reacting to
+ * a tick can be broken down into its parts. Without SCHED_PROBES, the probe
+ * macros expand to nothing and the operations are not timed at all.
+ */
+
+#ifndef _PROBES_H_
+#define _PROBES_H_
+
+/**
+ * @brief Timed operations.
+ */
+typedef enum ProbeKind {
+  _PROBE_TICK,       /**< From a clock tick to the end of its engine step */
+  _PROBE_STEP,       /**< Engine step */
+  _PROBE_ARRIVE,     /**< Admission of the processes of a time step */
+  _PROBE_START,      /**< Starting a process on a worker */
+  _PROBE_STOP,       /**< Stopping a process */
+  _PROBE_RESUME,     /**< Resuming a process */
+  _PROBE_ENQUEUE,    /**< Ready queue insertion */
+  _PROBE_DEQUEUE,    /**< Ready queue removal */
+  _PROBE_ALLOCATE,   /**< Memory allocation */
+  _PROBE_DEALLOCATE, /**< Memory release */
+  _PROBE_KINDS       /**< Number of operations */
+} ProbeKind;
+
+#ifdef SCHED_PROBES
+
+/**
+ * @brief Name of every timed operation in the dump.
+ */
+static const char* const probeNames[_PROBE_KINDS] = {
+    "tick",   "step",    "arrive",  "start",    "stop",
+    "resume", "enqueue", "dequeue", "allocate", "deallocate"};
+
+///==============================
+Histogram probeHistograms[_PROBE_KINDS];  // NOLINT
+//===============================
+
+/**
+ * @brief Reads the monotonic clock.
+ *
+ * @return The time in nanoseconds.
+ */
+long long Probe_now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * @brief Counts the time an operation took.
+ *
+ * @param kind The operation.
+ * @param ns Its duration in nanoseconds.
+ */
+void Probe_record(ProbeKind kind, long long ns) {
+  Histogram_record(&probeHistograms[kind], ns);
+}
+
+/**
+ * @brief Writes the latency of every operation timed so far, in
+ * nanoseconds.
+ *
+ * @param name Path of the dump.
+ */
+void Probe_write(const char* name) {
+  FILE* out = fopen(name, "w");
+  if (out == NULL) {
+    perror("Error creating the probes dump");
+    return;
+  }
+  fprintf(out, "%-10s %10s %10s %10s %10s %10s %10s %10s\n", "probe",
+          "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+  for (int k = 0; k < _PROBE_KINDS; k++) {
+    Histogram* h = &probeHistograms[k];
+    fprintf(out, "%-10s %10lld %10lld %10lld %10lld %10lld %10lld %10lld\n",
+            probeNames[k], h->total, h->total > 0 ? h->sum / h->total : 0,
+            Histogram_percentile(h, 50), Histogram_percentile(h, 90),
+            Histogram_percentile(h, 99), Histogram_percentile(h, 99.9),
+            h->max);
+  }
+  fclose(out);
+}
+
+/** Starts timing an operation in a new variable. */
+#define PROBE_BEGIN(start) long long start = Probe_now()
+/** Counts the time since start, which is only evaluated with probes. */
+#define PROBE_END(kind, start) Probe_record(kind, Probe_now() - (start))
+
+#else
+
+#define PROBE_BEGIN(start)
+#define PROBE_END(kind, start)
+
+#endif /* SCHED_PROBES */
+
+#endif /* _PROBES_H_ */
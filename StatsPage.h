@@ -0,0 +1,118 @@
+/**
+ * @file StatsPage.h
+ * @brief Live statistics of the scheduler, published in shared memory.
+ *
+ * The scheduler copies its state into a StatsPage after every engine step
+ * and every batch of arrivals. Monitoring tools such as schedtop attach the
+ * page read-only and poll it whenever they like: they never make a system
+ * call into the scheduler, and the scheduler never waits for them.
+ *
+ * The page is guarded by a sequence lock. The scheduler makes the sequence
+ * number odd before it updates the page and even again after, and a reader
+ * keeps a copy only if it read the same even number before and after taking
+ * it, so it never sees a half-written page.
+ */
+
+#ifndef _STATS_PAGE_H_
+#define _STATS_PAGE_H_
+
+/**
+ * @brief Statistics of the scheduler at one point of the run.
+ */
+typedef struct StatsPage {
+  unsigned int seq;                 /**< Odd while the page is updated */
+  bool done;                        /**< The scheduler has finished */
+  int tick;                         /**< Time step of the last update */
+  int algo;                         /**< Scheduling algorithm */
+  int cpus;                         /**< Number of CPUs */
+  int ready;                        /**< Processes in the ready queues */
+  int memoryWait;                   /**< Processes waiting for memory */
+  int finished;                     /**< Finished processes */
+  int rejected;                     /**< Rejected processes */
+  long long switches;               /**< Processes given a CPU so far */
+  int minOrder;                     /**< Order of the minimum block */
+  int maxOrder;                     /**< Order of the whole memory */
+  long long freeBlocks[MAX_ORDERS]; /**< Free blocks of every order */
+  int runningId[__MAX_CPUS__];      /**< Process of every CPU, -1 if idle */
+} StatsPage;
+
+/**
+ * @brief Creates the stats page, replacing a page left over by a previous
+ * run.
+ *
+ * @param shmid Set to the id of the shared memory segment.
+ * @return Pointer to the attached page.
+ */
+StatsPage* StatsPage_create(int* shmid) {
+  key_t key_id = ftok(__FILE_KEY_NAME__, __STATS_KEY_VAL__);
+  *shmid = shmget(key_id, sizeof(StatsPage), IPC_CREAT | IPC_EXCL | 0644);
+  if (*shmid == -1 && errno == EEXIST) {
+    shmctl(shmget(key_id, 0, 0644), IPC_RMID, NULL);
+    *shmid = shmget(key_id, sizeof(StatsPage), IPC_CREAT | IPC_EXCL | 0644);
+  }
+  if (*shmid == -1) {
+    perror("Error in creating the stats page");
+    exit(-1);
+  }
+  StatsPage* page = (StatsPage*)shmat(*shmid, (void*)0, 0);
+  if ((long)page == -1) {
+    perror("Error in attaching the stats page");
+    exit(-1);
+  }
+  memset(page, 0, sizeof(StatsPage));
+  return page;
+}
+
+/**
+ * @brief Copies the state of the engine and the memory into the page.
+ *
+ * @param page Pointer to the page.
+ * @param e Pointer to the engine.
+ * @param done The scheduler has finished.
+ */
+void StatsPage_publish(StatsPage* page, Engine* e, bool done) {
+  unsigned int seq = page->seq;
+  __atomic_store_n(&page->seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  page->done = done;
+  page->tick = e->oldClk;
+  page->algo = e->algo;
+  page->cpus = e->cpus;
+  page->ready = e->ready;
+  page->memoryWait = e->memoryWait.size;
+  page->finished = e->finished;
+  page->rejected = e->rejected;
+  page->switches = e->switches;
+  page->minOrder = globalAllocator.minOrder;
+  page->maxOrder = globalAllocator.maxOrder;
+  for (int k = globalAllocator.minOrder; k <= globalAllocator.maxOrder; k++) {
+    page->freeBlocks[k] = (long long)globalAllocator.freeCount[k];
+  }
+  for (int c = 0; c < e->cpus; c++) {
+    page->runningId[c] = e->cpu[c].currently ? e->cpu[c].process.id : -1;
+  }
+  __atomic_store_n(&page->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Takes a consistent copy of the page, retrying while the scheduler
+ * updates it.
+ *
+ * @param page Pointer to the shared page.
+ * @param copy Pointer to the copy.
+ */
+void StatsPage_read(const StatsPage* page, StatsPage* copy) {
+  while (1) {
+    unsigned int before = __atomic_load_n(&page->seq, __ATOMIC_ACQUIRE);
+    if (before % 2 == 0) {
+      memcpy(copy, page, sizeof(StatsPage));
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&page->seq, __ATOMIC_RELAXED) == before) {
+        return;
+      }
+    }
+    sched_yield();
+  }
+}
+
+#endif /* _STATS_PAGE_H_ */
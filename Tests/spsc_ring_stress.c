@@ -0,0 +1,148 @@
+/**
+ * @file spsc_ring_stress.c
+ * @brief Stress test of the arrivals ring under time steps larger than it.
+ *
+ * A forked producer sends time steps of up to three times the capacity of a
+ * small ring, split into batches the way the process generator splits them,
+ * while the consumer drains it and checks that every record arrives once and
+ * in order. The producer keeps sleeping for room, so a lost wakeup leaves it
+ * asleep with the ring empty, which the test reports as a deadlock once the
+ * consumer has seen no record for __STALL_SECONDS__.
+ */
+
+#include "../headers.h"
+
+/******************** MACROS ********************/
+#define __CAPACITY__ 64     /**< Slots of the ring under test */
+#define __TICKS__ 200000    /**< Time steps sent */
+#define __STALL_SECONDS__ 5 /**< Time without a record that is a deadlock */
+#define __SEED__ 42         /**< Seed of the batch sizes */
+/************************************************/
+
+/**
+ * @brief Returns the next number of a xorshift generator.
+ *
+ * @param state Pointer to the state, never 0.
+ * @return The next pseudo-random number.
+ */
+unsigned long long nextRandom(unsigned long long* state) {
+  unsigned long long x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+/**
+ * @brief Sends every time step through the ring, then exits.
+ *
+ * @param ring Pointer to the ring.
+ */
+void produce(SPSC_Ring* ring) {
+  ProcessRecord batch[__CAPACITY__ - 1];
+  unsigned long long state = __SEED__;
+  int id = 0;
+  for (int tick = 0; tick < __TICKS__; tick++) {
+    int size = (int)(nextRandom(&state) % (3 * __CAPACITY__));
+    while (size > 0) {
+      int count = size < __CAPACITY__ - 1 ? size : __CAPACITY__ - 1;
+      for (int i = 0; i < count; i++) {
+        batch[i].id = id++;
+        batch[i].arrivalTime = tick;
+      }
+      SPSC_Ring_pushBatch(ring, tick, batch, count);
+      size -= count;
+    }
+  }
+  exit(0);
+}
+
+/**
+ * @brief Drains the ring until the producer sent everything, checking the
+ * records.
+ *
+ * @param ring Pointer to the ring.
+ * @param producer Process ID of the producer.
+ * @return The number of records received.
+ */
+long consume(SPSC_Ring* ring, int producer) {
+  long received = 0;
+  int lastTick = 0;
+  time_t lastRecord = time(NULL);
+  bool done = false;
+  while (true) {
+    BatchHeader header;
+    if (!SPSC_Ring_peekBatch(ring, &header)) {
+      if (done) {
+        return received;
+      }
+      if (waitpid(producer, NULL, WNOHANG) == producer) {
+        /* Drain what it sent before it exited */
+        done = true;
+        continue;
+      }
+      if (time(NULL) - lastRecord >= __STALL_SECONDS__) {
+        fprintf(stderr,
+                "Deadlock: the ring is empty and the producer sleeps "
+                "after %ld records\n",
+                received);
+        kill(producer, SIGKILL);
+        exit(-1);
+      }
+      sched_yield();
+      continue;
+    }
+    if (header.tick < lastTick) {
+      fprintf(stderr, "Time step %d received after %d\n", header.tick,
+              lastTick);
+      exit(-1);
+    }
+    for (int i = 0; i < header.count; i++) {
+      const ProcessRecord* record = SPSC_Ring_record(ring, i);
+      if (record->id != received || record->arrivalTime != header.tick) {
+        fprintf(stderr, "Record %d of time step %d received as record %ld\n",
+                record->id, record->arrivalTime, received);
+        exit(-1);
+      }
+      received++;
+    }
+    lastTick = header.tick;
+    lastRecord = time(NULL);
+    SPSC_Ring_popBatch(ring, &header);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  SPSC_Ring* ring = (SPSC_Ring*)mmap(NULL, SPSC_Ring_bytes(__CAPACITY__),
+                                     PROT_READ | PROT_WRITE,
+                                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (ring == MAP_FAILED) {
+    perror("Error in mapping the ring");
+    exit(-1);
+  }
+  SPSC_Ring_Init(ring, __CAPACITY__);
+  int producer = fork();
+  if (producer == -1) {
+    perror("Error in fork");
+    exit(-1);
+  }
+  if (producer == 0) {
+    produce(ring);
+  }
+  long received = consume(ring, producer);
+  /* Replay the batch sizes to know how many records were sent */
+  unsigned long long state = __SEED__;
+  long sent = 0;
+  for (int tick = 0; tick < __TICKS__; tick++) {
+    sent += (long)(nextRandom(&state) % (3 * __CAPACITY__));
+  }
+  if (received != sent) {
+    fprintf(stderr, "%ld records received out of %ld\n", received, sent);
+    exit(-1);
+  }
+  printf("spsc_ring_stress: %ld records of %d time steps received\n",
+         received, __TICKS__);
+  munmap(ring, SPSC_Ring_bytes(__CAPACITY__));
+  return 0;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file Trace.h
+ * @brief Binary trace of the scheduling events, written into a mapped ring.
+ *
+ * Every event is a fixed-width TraceRecord stored right into a file mapped
+ * in memory, so recording one costs a few stores: nothing is formatted and
+ * no system call is made while the scheduler runs. The kernel writes the
+ * pages back on its own, and the decoder turns the file into text offline.
+ *
+ * The file is a TraceHeader followed by a ring of TRACE_RECORDS records.
+ * Once the ring is full, the newest records overwrite the oldest ones, so a
+ * long run keeps its last TRACE_RECORDS events. The header counts every
+ * record written, which tells the decoder where the ring starts and how many
+ * records were lost. A ring that never wrapped is cut down to its records
+ * when the trace is closed. The size of the ring can be set at build time
+ * with -DTRACE_RECORDS=<power of 2>.
+ */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+/******************** MACROS ********************/
+#define TRACE_MAGIC "TRC\x7f"     /**< Starts a trace file */
+#define TRACE_VERSION 1           /**< Trace format version */
+#ifndef TRACE_RECORDS
+#define TRACE_RECORDS (1LL << 22) /**< Records in the ring, a power of 2 */
+#endif
+/************************************************/
+
+/**
+ * @brief Kinds of traced events.
+ */
+typedef enum TraceKind {
+  _TRACE_RECEIVE,   /**< A process arrived and was admitted */
+  _TRACE_REJECT,    /**< A process needs more memory than there is */
+  _TRACE_START,     /**< A process got memory and ran for the first time */
+  _TRACE_RESUME,    /**< A stopped process got a CPU again */
+  _TRACE_STOP,      /**< A process was preempted */
+  _TRACE_REMAINING, /**< Remaining time of a running process at a step */
+  _TRACE_FINISH,    /**< A process finished and released its memory */
+  _TRACE_KINDS      /**< Number of kinds */
+} TraceKind;
+
+/**
+ * @brief Header of a trace file.
+ */
+typedef struct TraceHeader {
+  char magic[4];      /**< TRACE_MAGIC */
+  int version;        /**< TRACE_VERSION */
+  int recordSize;     /**< sizeof(struct TraceRecord) */
+  int algo;           /**< Scheduling algorithm */
+  int cpus;           /**< Number of CPUs */
+  int reserved;       /**< Keeps the counters aligned */
+  long long capacity; /**< Records in the ring */
+  long long head;     /**< Records written so far */
+} TraceHeader;
+
+/**
+ * @brief One traced event. The memory block is only set for START and FINISH.
+ */
+typedef struct TraceRecord {
+  int tick;                  /**< Time step of the event */
+  unsigned char kind;        /**< TraceKind */
+  unsigned char order;       /**< log2 of the size of its memory block */
+  unsigned short cpu;        /**< CPU of the event, 0 if it has none */
+  int id;                    /**< Process id */
+  int remaining;             /**< Remaining time of the process */
+  int wait;                  /**< Waiting time of the process so far */
+  int memory;                /**< Memory requested by the process */
+  unsigned long long offset; /**< Start of its memory block */
+} TraceRecord;
+
+/**
+ * @brief State of a trace being written.
+ */
+typedef struct Trace {
+  struct TraceHeader* header;  /**< Mapped header */
+  struct TraceRecord* records; /**< Mapped ring */
+  long long mask;              /**< capacity - 1 */
+  int fd;                      /**< The trace file */
+} Trace;
+
+/**
+ * @brief Returns the size of a trace file holding some records.
+ *
+ * @param records Number of records.
+ * @return The size in bytes.
+ */
+size_t Trace_bytes(long long records) {
+  return sizeof(struct TraceHeader) +
+         (size_t)records * sizeof(struct TraceRecord);
+}
+
+/**
+ * @brief Creates a trace file and maps its ring.
+ *
+ * The file is only sized, not written, so the ring takes disk space as it
+ * fills.
+ *
+ * @param t Pointer to the trace.
+ * @param name Path of the file.
+ * @param algo Scheduling algorithm.
+ * @param cpus Number of CPUs.
+ */
+void Trace_open(Trace* t, const char* name, int algo, int cpus) {
+  t->fd = open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (t->fd == -1) {
+    perror("Error creating the trace");
+    exit(-1);
+  }
+  size_t size = Trace_bytes(TRACE_RECORDS);
+  if (ftruncate(t->fd, (off_t)size) == -1) {
+    perror("Error sizing the trace");
+    exit(-1);
+  }
+  void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, t->fd, 0);
+  if (data == MAP_FAILED) {
+    perror("Error mapping the trace");
+    exit(-1);
+  }
+  t->header = (struct TraceHeader*)data;
+  t->records = (struct TraceRecord*)(t->header + 1);
+  t->mask = TRACE_RECORDS - 1;
+  memcpy(t->header->magic, TRACE_MAGIC, 4);
+  t->header->version = TRACE_VERSION;
+  t->header->recordSize = sizeof(struct TraceRecord);
+  t->header->algo = algo;
+  t->header->cpus = cpus;
+  t->header->reserved = 0;
+  t->header->capacity = TRACE_RECORDS;
+  t->header->head = 0;
+}
+
+/**
+ * @brief Records an event of a process.
+ *
+ * @param t Pointer to the trace.
+ * @param kind Kind of the event.
+ * @param tick Time step of the event.
+ * @param cpu CPU of the event.
+ * @param process Pointer to the PCB of the process.
+ */
+void Trace_write(Trace* t, TraceKind kind, int tick, int cpu,
+                 const struct PCB* process) {
+  struct TraceRecord* r = &t->records[t->header->head & t->mask];
+  r->tick = tick;
+  r->kind = (unsigned char)kind;
+  r->order = 0;
+  r->cpu = (unsigned short)cpu;
+  r->id = process->id;
+  r->remaining = process->remainingTime;
+  r->wait = process->waitTime;
+  r->memory = process->memory;
+  r->offset = 0;
+  if ((kind == _TRACE_START || kind == _TRACE_FINISH) &&
+      process->memPointer != NULL) {
+    r->offset = getStartAddress(process->memPointer);
+    r->order = (unsigned char)__builtin_ctzll(
+        getEndAddress(process->memPointer) - r->offset + 1);
+  }
+  t->header->head++;
+}
+
+/**
+ * @brief Unmaps a trace, and cuts its file down to the records written if
+ * the ring never wrapped.
+ *
+ * @param t Pointer to the trace.
+ */
+void Trace_close(Trace* t) {
+  long long head = t->header->head;
+  munmap(t->header, Trace_bytes(TRACE_RECORDS));
+  if (head < TRACE_RECORDS) {
+    if (ftruncate(t->fd, (off_t)Trace_bytes(head)) == -1) {
+      perror("Error cutting the trace");
+    }
+  }
+  close(t->fd);
+  t->header = NULL;
+  t->records = NULL;
+}
+
+#endif /* _TRACE_H_ */
@@ -0,0 +1,284 @@
+/**
+ * @file WorkerPool.h
+ * @brief Pool of pre-forked process.out workers used by the scheduler.
+ *
+ * Forking and executing process.out for every dispatched process costs
+ * milliseconds, and killed processes were never reaped. Instead, workers are
+ * forked once and handed processes over a control channel: a WorkerSlot per
+ * worker in a shared memory segment, whose sequence number the worker sleeps
+ * on with a futex. A worker goes back to the pool as soon as its process
+ * leaves the CPU, whether it finished or was preempted: the progress of a
+ * process is kept in its PCB and counted from the base and since of the slot,
+ * so a preempted process resumes on whichever worker is idle. The pool thus
+ * only grows when every worker runs a process, up to one worker per CPU.
+ * Workers are told to exit and reaped with waitpid when the pool is
+ * destroyed.
+ *
+ * A running worker follows the clock and publishes the remaining time of its
+ * process in its slot at every time step; it sleeps in between, or runs a
+ * synthetic CPU or memory kernel if the pool was created with one.
+ *
+ * Workers can be pinned to host CPUs with sched_setaffinity, so the simulated
+ * CPUs of the engine map onto real ones.
+ */
+
+#ifndef _WORKER_POOL_H_
+#define _WORKER_POOL_H_
+
+/******************** MACROS ********************/
+#define WORKER_POOL_MAX __MAX_CPUS__ /**< Largest number of workers */
+/************************************************/
+
+/**
+ * @brief Structure representing the pool.
+ */
+typedef struct WorkerPool {
+  int shmId;                /**< Shared memory ID of the slots */
+  struct WorkerSlot* slots; /**< Control channels of the workers */
+  int* pids;                /**< Process ID of every worker */
+  int* idle;                /**< Stack of the idle workers */
+  int idleCount;            /**< Number of idle workers */
+  int size;                 /**< Number of workers forked */
+  const char* kernel;       /**< Work done while running a process */
+  const char* kernelBytes;  /**< Memory used by the memory kernel */
+  int* pinned;              /**< Host CPU of every worker, -1 if unpinned */
+  int* hostCpus;            /**< Host CPUs the scheduler may run on */
+  int hostCount;            /**< Number of host CPUs */
+} WorkerPool;
+
+/**
+ * @brief Forks a new worker and adds it to the idle ones.
+ *
+ * @param pool Pointer to the pool.
+ */
+void WorkerPool_spawn(WorkerPool* pool) {
+  if (pool->size == WORKER_POOL_MAX) {
+    fprintf(stderr, "More than %d processes are running\n", WORKER_POOL_MAX);
+    exit(-1);
+  }
+  int w = pool->size;
+  pool->slots[w].seq = 0;
+  pool->slots[w].command = _WORKER_IDLE;
+  pool->slots[w].id = -1;
+  pool->slots[w].clk = -1;
+  int pid = fork();
+  if (pid == -1) {
+    perror("Error in forking of a worker");
+    exit(-1);
+  } else if (pid == 0) {
+    char shmId[12], slot[12];
+    sprintf(shmId, "%d", pool->shmId);  // NOLINT
+    sprintf(slot, "%d", w);             // NOLINT
+    execl("./process.out", "process.out", shmId, slot, pool->kernel,
+          pool->kernelBytes, NULL);
+    perror("Error in process");
+    exit(-1);
+  }
+  pool->pids[w] = pid;
+  pool->pinned[w] = -1;
+  pool->idle[pool->idleCount++] = w;
+  pool->size++;
+}
+
+/**
+ * @brief Creates the pool and forks its first workers.
+ *
+ * The segment is marked for removal right away, so it cannot leak; Linux
+ * still lets the workers forked later attach it while the scheduler holds it.
+ *
+ * @param pool Pointer to the pool.
+ * @param workers Number of workers forked up front.
+ * @param kernel Work done while running a process: sleep, cpu or memory.
+ * @param kernelBytes Memory used by the memory kernel, e.g. 64M.
+ */
+void WorkerPool_Init(WorkerPool* pool, int workers, const char* kernel,
+                     const char* kernelBytes) {
+  pool->kernel = kernel;
+  pool->kernelBytes = kernelBytes;
+  pool->shmId = shmget(IPC_PRIVATE, WORKER_POOL_MAX * sizeof(WorkerSlot),
+                       IPC_CREAT | 0600);
+  if (pool->shmId == -1) {
+    perror("Error in creating the worker pool");
+    exit(-1);
+  }
+  pool->slots = (WorkerSlot*)shmat(pool->shmId, (void*)0, 0);
+  if ((long)pool->slots == -1) {
+    perror("Error in attaching the worker pool");
+    exit(-1);
+  }
+  shmctl(pool->shmId, IPC_RMID, NULL);
+  pool->pids = (int*)malloc(WORKER_POOL_MAX * sizeof(int));    // NOLINT
+  pool->idle = (int*)malloc(WORKER_POOL_MAX * sizeof(int));    // NOLINT
+  pool->pinned = (int*)malloc(WORKER_POOL_MAX * sizeof(int));  // NOLINT
+  pool->hostCpus = (int*)malloc(CPU_SETSIZE * sizeof(int));    // NOLINT
+  if (pool->pids == NULL || pool->idle == NULL || pool->pinned == NULL ||
+      pool->hostCpus == NULL) {
+    perror("Memory allocation failed");
+    exit(-1);
+  }
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) == -1) {
+    perror("Error in reading the CPU affinity");
+    exit(-1);
+  }
+  pool->hostCount = 0;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &allowed)) {
+      pool->hostCpus[pool->hostCount++] = cpu;
+    }
+  }
+  pool->idleCount = 0;
+  pool->size = 0;
+  for (int i = 0; i < workers; i++) {
+    WorkerPool_spawn(pool);
+  }
+}
+
+/**
+ * @brief Gives a command to a worker and wakes it up.
+ *
+ * An idle worker sleeps on its slot, while a running one may sleep on the
+ * clock, so both are woken.
+ *
+ * @param pool Pointer to the pool.
+ * @param w Index of the worker.
+ * @param command Command to be given.
+ * @param id Id of the process concerned.
+ */
+void WorkerPool_command(WorkerPool* pool, int w, int command, int id) {
+  WorkerSlot* slot = &pool->slots[w];
+  slot->command = command;
+  slot->id = id;
+  __atomic_add_fetch(&slot->seq, 1, __ATOMIC_RELEASE);
+  syscall(SYS_futex, &slot->seq, FUTEX_WAKE, 1, NULL, NULL, 0);
+  if (command != _WORKER_RUN) {
+    notifyEvent();
+  }
+}
+
+/**
+ * @brief Records that a process gets the CPU, which the remaining time the
+ * worker publishes counts from.
+ *
+ * @param pool Pointer to the pool.
+ * @param w Index of the worker.
+ * @param remaining Remaining time of the process.
+ * @param clk Current time step.
+ */
+void WorkerPool_account(WorkerPool* pool, int w, int remaining, int clk) {
+  pool->slots[w].base = remaining;
+  pool->slots[w].since = clk;
+}
+
+/**
+ * @brief Pins a worker to the host CPU standing for a simulated CPU; the
+ * simulated CPUs wrap around the host CPUs the scheduler may run on.
+ *
+ * @param pool Pointer to the pool.
+ * @param w Index of the worker.
+ * @param cpu Index of the simulated CPU.
+ */
+void WorkerPool_pin(WorkerPool* pool, int w, int cpu) {
+  int host = pool->hostCpus[cpu % pool->hostCount];
+  if (pool->pinned[w] == host) {
+    return;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(host, &set);
+  if (sched_setaffinity(pool->pids[w], sizeof(set), &set) == -1) {
+    perror("Error in pinning a worker");
+    exit(-1);
+  }
+  pool->pinned[w] = host;
+}
+
+/**
+ * @brief Waits until the worker of the running process published a time
+ * step, and returns the remaining time of the process at it.
+ *
+ * @param pool Pointer to the pool.
+ * @param w Index of the worker.
+ * @param clk Time step to wait for.
+ * @return Remaining time of the process.
+ */
+int WorkerPool_progress(WorkerPool* pool, int w, int clk) {
+  WorkerSlot* slot = &pool->slots[w];
+  int published;
+  while ((published = __atomic_load_n(&slot->clk, __ATOMIC_ACQUIRE)) < clk) {
+    syscall(SYS_futex, &slot->clk, FUTEX_WAIT, published, NULL, NULL, 0);
+  }
+  return slot->remaining;
+}
+
+/**
+ * @brief Collects the children that died, failing if one of them is a worker,
+ * which must never die while the pool is in use.
+ *
+ * @param pool Pointer to the pool.
+ */
+void WorkerPool_reap(WorkerPool* pool) {
+  int pid;
+  while ((pid = waitpid(-1, NULL, WNOHANG)) > 0) {
+    for (int w = 0; w < pool->size; w++) {
+      if (pool->pids[w] == pid) {
+        fprintf(stderr, "Worker %d with PID = %d died unexpectedly\n", w, pid);
+        exit(-1);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Hands a process to an idle worker, forking one if none is idle.
+ *
+ * @param pool Pointer to the pool.
+ * @param id Id of the process.
+ * @param remaining Remaining time of the process.
+ * @param clk Current time step.
+ * @return Index of the worker running the process.
+ */
+int WorkerPool_assign(WorkerPool* pool, int id, int remaining, int clk) {
+  if (pool->idleCount == 0) {
+    WorkerPool_spawn(pool);
+  }
+  int w = pool->idle[--pool->idleCount];
+  WorkerPool_account(pool, w, remaining, clk);
+  WorkerPool_command(pool, w, _WORKER_RUN, id);
+  return w;
+}
+
+/**
+ * @brief Takes a worker back once its process finished or was preempted.
+ *
+ * @param pool Pointer to the pool.
+ * @param w Index of the worker.
+ */
+void WorkerPool_release(WorkerPool* pool, int w) {
+  WorkerPool_command(pool, w, _WORKER_RELEASE, -1);
+  pool->idle[pool->idleCount++] = w;
+  WorkerPool_reap(pool);
+}
+
+/**
+ * @brief Tells every worker to exit and reaps them.
+ *
+ * @param pool Pointer to the pool.
+ */
+void WorkerPool_destroy(WorkerPool* pool) {
+  for (int w = 0; w < pool->size; w++) {
+    WorkerPool_command(pool, w, _WORKER_EXIT, -1);
+  }
+  for (int w = 0; w < pool->size; w++) {
+    waitpid(pool->pids[w], NULL, 0);
+  }
+  shmdt(pool->slots);
+  free(pool->pids);
+  free(pool->idle);
+  free(pool->pinned);
+  free(pool->hostCpus);
+  pool->size = 0;
+  pool->idleCount = 0;
+}
+
+#endif /* _WORKER_POOL_H_ */
@@ -0,0 +1,462 @@
+/**
+ * @file Workload.h
+ * @brief Streaming reader and writer of the processes file, in text or binary
+ * format.
+ *
+ * The file is mapped into memory and read in a single pass, one process at a
+ * time, so opening even a huge file costs nothing. The pages already read
+ * are handed back to the kernel as the reader moves on, which keeps the
+ * memory used constant whatever the length of the file.
+ *
+ * In the text format, each line holds the id, arrival time, run time,
+ * priority and memory of a process, separated by blanks, and is parsed by a
+ * small integer scanner. Empty lines and lines starting with '#' are skipped.
+ *
+ * The binary format is a WorkloadHeader followed by the processes as
+ * fixed-width ProcessRecords, in the byte order of the machine. The records
+ * are used right from the mapping, without parsing or copying them. The
+ * format is told apart by its magic number, so every reader accepts both.
+ *
+ * In both formats, the processes must be sorted by arrival time.
+ */
+
+#ifndef _WORKLOAD_H_
+#define _WORKLOAD_H_
+
+/******************** MACROS ********************/
+#define WORKLOAD_RELEASE_BYTES (16UL << 20) /**< Read bytes per release */
+#define WORKLOAD_MAGIC "PRC\x7f"            /**< Starts a binary file */
+#define WORKLOAD_VERSION 1                  /**< Binary format version */
+#define WORKLOAD_TEXT_HEADER "#id arrival runtime priority memory\n"
+#define WORKLOAD_LINE_MAX 64                /**< Longest text line */
+/************************************************/
+
+/**
+ * @brief Header of a binary processes file.
+ */
+typedef struct WorkloadHeader {
+  char magic[4];   /**< WORKLOAD_MAGIC */
+  int version;     /**< WORKLOAD_VERSION */
+  long long count; /**< Number of processes */
+  int minArrival;  /**< Arrival time of the first process */
+  int maxArrival;  /**< Arrival time of the last process */
+} WorkloadHeader;
+
+/**
+ * @brief State of a processes file being read.
+ */
+typedef struct Workload {
+  const char* name;                    /**< Path, for error messages */
+  char* data;                          /**< Mapping of the whole file */
+  size_t size;                         /**< Size of the file in bytes */
+  size_t pos;                          /**< Offset of the next byte to read */
+  size_t released;                     /**< Offset released up to */
+  int line;                            /**< Line being parsed, in text */
+  bool binary;                         /**< The file is in binary format */
+  struct WorkloadHeader header;        /**< Header, in binary */
+  const struct ProcessRecord* records; /**< Mapped records, in binary */
+  long long index;                     /**< Next record, in binary */
+  bool pending;                        /**< A process is left to read */
+  struct ProcessRecord next;           /**< Next process, read ahead */
+  struct ProcessRecord* buffer;        /**< Processes taken, in text */
+  int bufferCapacity;                  /**< Length of the buffer */
+} Workload;
+
+/**
+ * @brief State of a processes file being written.
+ */
+typedef struct WorkloadWriter {
+  FILE* file;                   /**< Output file */
+  bool binary;                  /**< Write the binary format */
+  struct WorkloadHeader header; /**< Header, completed while writing */
+} WorkloadWriter;
+
+/**
+ * @brief Skips the blanks in front of the next field of the line.
+ *
+ * @param w Pointer to the workload.
+ */
+void Workload_skipBlanks(Workload* w) {
+  while (w->pos < w->size &&
+         (w->data[w->pos] == ' ' || w->data[w->pos] == '\t')) {
+    w->pos++;
+  }
+}
+
+/**
+ * @brief Moves past the end of the current line.
+ *
+ * @param w Pointer to the workload.
+ */
+void Workload_skipLine(Workload* w) {
+  const char* end = (const char*)memchr(w->data + w->pos, '\n',
+                                        w->size - w->pos);
+  w->pos = end == NULL ? w->size : (size_t)(end - w->data) + 1;
+  w->line++;
+}
+
+/**
+ * @brief Scans a decimal integer, optionally negative, from the current line.
+ *
+ * @param w Pointer to the workload.
+ * @param value Pointer to the integer to be filled.
+ * @return true if an integer was scanned, false otherwise.
+ */
+bool Workload_scanInt(Workload* w, int* value) {
+  Workload_skipBlanks(w);
+  bool negative = false;
+  if (w->pos < w->size && w->data[w->pos] == '-') {
+    negative = true;
+    w->pos++;
+  }
+  size_t start = w->pos;
+  long long result = 0;
+  while (w->pos < w->size && w->data[w->pos] >= '0' &&
+         w->data[w->pos] <= '9') {
+    result = result * 10 + (w->data[w->pos++] - '0');
+    if (result > INT_MAX) {
+      return false;
+    }
+  }
+  *value = (int)(negative ? -result : result);
+  return (bool)(w->pos > start);
+}
+
+/**
+ * @brief Gives the pages read so far back to the kernel, once enough of
+ * them piled up.
+ *
+ * @param w Pointer to the workload.
+ */
+void Workload_release(Workload* w) {
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t end = w->pos & ~(page - 1);
+  if (end - w->released >= WORKLOAD_RELEASE_BYTES) {
+    madvise(w->data + w->released, end - w->released, MADV_DONTNEED);
+    w->released = end;
+  }
+}
+
+/**
+ * @brief Parses the next process of a text file.
+ *
+ * A malformed line is reported with its number and ends the program.
+ *
+ * @param w Pointer to the workload.
+ * @param record Pointer to the record to be filled.
+ * @return true if a process was parsed, false at the end of the file.
+ */
+bool Workload_parse(Workload* w, struct ProcessRecord* record) {
+  while (w->pos < w->size) {
+    Workload_skipBlanks(w);
+    if (w->pos == w->size) {
+      break;
+    }
+    char first = w->data[w->pos];
+    if (first == '#' || first == '\n' || first == '\r') {
+      Workload_skipLine(w);
+      continue;
+    }
+    if (!Workload_scanInt(w, &record->id) ||
+        !Workload_scanInt(w, &record->arrivalTime) ||
+        !Workload_scanInt(w, &record->runTime) ||
+        !Workload_scanInt(w, &record->prio) ||
+        !Workload_scanInt(w, &record->memory)) {
+      fprintf(stderr,
+              "%s:%d: expected id, arrival, runtime, priority and memory\n",
+              w->name, w->line);
+      exit(-1);
+    }
+    Workload_skipLine(w);
+    Workload_release(w);
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Opens and maps a processes file.
+ *
+ * @param w Pointer to the workload.
+ * @param name Path of the file.
+ */
+void Workload_open(Workload* w, const char* name) {
+  int fd = open(name, O_RDONLY);
+  if (fd == -1) {
+    perror("Error opening file");
+    exit(-1);
+  }
+  struct stat info;
+  if (fstat(fd, &info) == -1) {
+    perror("Error reading file");
+    exit(-1);
+  }
+  w->name = name;
+  w->data = NULL;
+  w->size = (size_t)info.st_size;
+  w->pos = 0;
+  w->released = 0;
+  w->line = 1;
+  w->binary = false;
+  w->records = NULL;
+  w->index = 0;
+  w->buffer = NULL;
+  w->bufferCapacity = 0;
+  if (w->size > 0) {
+    w->data = (char*)mmap(NULL, w->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (w->data == MAP_FAILED) {
+      perror("Error mapping file");
+      exit(-1);
+    }
+    madvise(w->data, w->size, MADV_SEQUENTIAL);
+  }
+  close(fd);
+  if (w->size >= sizeof(struct WorkloadHeader) &&
+      memcmp(w->data, WORKLOAD_MAGIC, 4) == 0) {
+    memcpy(&w->header, w->data, sizeof(struct WorkloadHeader));
+    if (w->header.version != WORKLOAD_VERSION || w->header.count < 0 ||
+        w->size != sizeof(struct WorkloadHeader) +
+                       (size_t)w->header.count * sizeof(struct ProcessRecord)) {
+      fprintf(stderr, "%s: unsupported or truncated binary file\n", name);
+      exit(-1);
+    }
+    w->binary = true;
+    w->records =
+        (const struct ProcessRecord*)(w->data + sizeof(struct WorkloadHeader));
+    w->pending = (bool)(w->header.count > 0);
+    if (w->pending) {
+      w->next = w->records[0];
+    }
+    return;
+  }
+  w->pending = Workload_parse(w, &w->next);
+}
+
+/**
+ * @brief Unmaps a processes file.
+ *
+ * @param w Pointer to the workload.
+ */
+void Workload_close(Workload* w) {
+  if (w->data != NULL) {
+    munmap(w->data, w->size);
+    w->data = NULL;
+  }
+  free(w->buffer);
+  w->buffer = NULL;
+}
+
+/**
+ * @brief Moves the read-ahead process to the one after it.
+ *
+ * @param w Pointer to the workload.
+ * @param taken Number of processes taken since the read-ahead one, which is
+ * always 1 for a text file.
+ */
+void Workload_advance(Workload* w, long long taken) {
+  if (!w->binary) {
+    w->pending = Workload_parse(w, &w->next);
+    return;
+  }
+  w->index += taken;
+  w->pending = (bool)(w->index < w->header.count);
+  if (w->pending) {
+    w->next = w->records[w->index];
+  }
+  w->pos = sizeof(struct WorkloadHeader) +
+           (size_t)w->index * sizeof(struct ProcessRecord);
+  Workload_release(w);
+}
+
+/**
+ * @brief Reads the next process of the file.
+ *
+ * @param w Pointer to the workload.
+ * @param record Pointer to the record to be filled.
+ * @return true if a process was read, false at the end of the file.
+ */
+bool Workload_next(Workload* w, struct ProcessRecord* record) {
+  if (!w->pending) {
+    return false;
+  }
+  *record = w->next;
+  Workload_advance(w, 1);
+  return true;
+}
+
+/**
+ * @brief Takes the processes arriving up to a time step.
+ *
+ * For a binary file, the processes are not copied: the returned pointer
+ * points into the mapping.
+ *
+ * @param w Pointer to the workload.
+ * @param until Last arrival time to take.
+ * @param limit Largest number of processes to take.
+ * @param count Pointer to the number of processes taken.
+ * @return Pointer to the processes taken, valid until the next call.
+ */
+const struct ProcessRecord* Workload_take(Workload* w, int until, int limit,
+                                          int* count) {
+  *count = 0;
+  if (w->binary) {
+    const struct ProcessRecord* first = &w->records[w->index];
+    while (*count < limit && w->index + *count < w->header.count &&
+           first[*count].arrivalTime <= until) {
+      (*count)++;
+    }
+    if (*count > 0) {
+      Workload_advance(w, *count);
+    }
+    return first;
+  }
+  while (*count < limit && w->pending && w->next.arrivalTime <= until) {
+    if (*count == w->bufferCapacity) {
+      int newCapacity = w->bufferCapacity == 0 ? 64 : w->bufferCapacity * 2;
+      w->buffer = (struct ProcessRecord*)realloc(
+          w->buffer, newCapacity * sizeof(struct ProcessRecord));  // NOLINT
+      if (w->buffer == NULL) {
+        perror("Error in allocating the processes");
+        exit(-1);
+      }
+      w->bufferCapacity = newCapacity;
+    }
+    w->buffer[(*count)++] = w->next;
+    Workload_advance(w, 1);
+  }
+  return w->buffer;
+}
+
+/**
+ * @brief Creates a processes file.
+ *
+ * @param wr Pointer to the writer.
+ * @param name Path of the file.
+ * @param binary Write the binary format instead of the text one.
+ */
+void WorkloadWriter_open(WorkloadWriter* wr, const char* name, bool binary) {
+  wr->file = fopen(name, "wb");
+  if (wr->file == NULL) {
+    perror("Error opening file");
+    exit(-1);
+  }
+  setvbuf(wr->file, NULL, _IOFBF, 1 << 20);
+  wr->binary = binary;
+  memcpy(wr->header.magic, WORKLOAD_MAGIC, 4);
+  wr->header.version = WORKLOAD_VERSION;
+  wr->header.count = 0;
+  wr->header.minArrival = 0;
+  wr->header.maxArrival = 0;
+  if (binary) {
+    /* Reserve the header, which is written once the counts are known */
+    fwrite(&wr->header, sizeof(struct WorkloadHeader), 1, wr->file);
+  } else {
+    fputs(WORKLOAD_TEXT_HEADER, wr->file);
+  }
+}
+
+/**
+ * @brief Formats an integer in decimal, without going through printf.
+ *
+ * @param out End of the buffer to be filled backwards.
+ * @param value Integer to be formatted.
+ * @return Pointer to the first character.
+ */
+char* WorkloadWriter_formatInt(char* out, int value) {
+  unsigned int magnitude = value < 0 ? 0U - (unsigned int)value
+                                     : (unsigned int)value;
+  do {
+    *--out = (char)('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude > 0);
+  if (value < 0) {
+    *--out = '-';
+  }
+  return out;
+}
+
+/**
+ * @brief Formats a process as a line of the text format.
+ *
+ * @param out Buffer of at least WORKLOAD_LINE_MAX characters to be filled.
+ * @param record Process to be formatted.
+ * @return Length of the line, which is not null-terminated.
+ */
+size_t WorkloadWriter_format(char* out, const struct ProcessRecord* record) {
+  const int fields[5] = {record->id, record->arrivalTime, record->runTime,
+                         record->prio, record->memory};
+  char line[WORKLOAD_LINE_MAX];
+  char* end = line + sizeof(line);
+  char* start = end;
+  *--start = '\n';
+  for (int i = 4; i >= 0; i--) {
+    start = WorkloadWriter_formatInt(start, fields[i]);
+    if (i > 0) {
+      *--start = '\t';
+    }
+  }
+  memcpy(out, start, (size_t)(end - start));
+  return (size_t)(end - start);
+}
+
+/**
+ * @brief Appends processes to the file.
+ *
+ * @param wr Pointer to the writer.
+ * @param records Processes to be appended.
+ * @param count Number of processes.
+ * @param text The processes already formatted by WorkloadWriter_format, or
+ * NULL to format them here. Unused for the binary format.
+ * @param length Length of the formatted text.
+ */
+void WorkloadWriter_writeBlock(WorkloadWriter* wr,
+                               const struct ProcessRecord* records, int count,
+                               const char* text, size_t length) {
+  if (count == 0) {
+    return;
+  }
+  if (wr->header.count == 0) {
+    wr->header.minArrival = records[0].arrivalTime;
+  }
+  wr->header.maxArrival = records[count - 1].arrivalTime;
+  wr->header.count += count;
+  if (wr->binary) {
+    fwrite(records, sizeof(struct ProcessRecord), (size_t)count, wr->file);
+  } else if (text != NULL) {
+    fwrite(text, 1, length, wr->file);
+  } else {
+    char line[WORKLOAD_LINE_MAX];
+    for (int i = 0; i < count; i++) {
+      fwrite(line, 1, WorkloadWriter_format(line, &records[i]), wr->file);
+    }
+  }
+}
+
+/**
+ * @brief Appends a process to the file.
+ *
+ * @param wr Pointer to the writer.
+ * @param record Process to be appended.
+ */
+void WorkloadWriter_write(WorkloadWriter* wr,
+                          const struct ProcessRecord* record) {
+  WorkloadWriter_writeBlock(wr, record, 1, NULL, 0);
+}
+
+/**
+ * @brief Completes and closes a processes file.
+ *
+ * @param wr Pointer to the writer.
+ */
+void WorkloadWriter_close(WorkloadWriter* wr) {
+  if (wr->binary) {
+    fseek(wr->file, 0, SEEK_SET);
+    fwrite(&wr->header, sizeof(struct WorkloadHeader), 1, wr->file);
+  }
+  if (fclose(wr->file) != 0) {
+    perror("Error writing file");
+    exit(-1);
+  }
+}
+
+#endif /* _WORKLOAD_H_ */
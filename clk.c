@@ -5,8 +5,12 @@
  * It is not a real part of operating system!
  */
 
+#include <time.h>
+
 #include "headers.h"
 
+#define __DEFAULT_TICK_PERIOD__ 1000000L /* Microseconds per tick */
+
 int shmid;  // NOLINT
 
 /* Clear the resources before exit */
@@ -16,25 +20,62 @@ void cleanup(int signum) {
   exit(0);
 }
 
-/* This file represents the system clock for ease of calculations */
+/*
+ * Sleeps until both the generator and the scheduler acknowledged the time
+ * step clk.
+ */
+void waitAcks(int clk) {
+  while (1) {
+    int seen = getEvents();
+    if (getSent() >= clk &&
+        __atomic_load_n(&clockPage->handledUpTo, __ATOMIC_ACQUIRE) >= clk) {
+      return;
+    }
+    waitEvent(seen);
+  }
+}
+
+/*
+ * This file represents the system clock for ease of calculations.
+ * The optional argument is the tick period in microseconds (default one
+ * second); with 0 the clock ticks as soon as the time step is acknowledged.
+ */
 int main(int argc, char *argv[]) {
   printf("Clock starting\n");
+  long period = argc > 1 ? atol(argv[1]) : __DEFAULT_TICK_PERIOD__;
   signal(SIGINT, cleanup);
   int clk = 0;
-  // Create shared memory for one integer variable 4 bytes
-  shmid = shmget(SHKEY, 4, IPC_CREAT | 0644);
+  // Create shared memory for the clock page
+  shmid = shmget(SHKEY, sizeof(ClockPage), IPC_CREAT | 0644);
   if ((long)shmid == -1) {
     perror("Error in creating shm!");
     exit(-1);
   }
-  int *shmaddr = (int *)shmat(shmid, (void *)0, 0);
-  if ((long)shmaddr == -1) {
+  clockPage = (ClockPage *)shmat(shmid, (void *)0, 0);
+  if ((long)clockPage == -1) {
     perror("Error in attaching the shm in clock!");
     exit(-1);
   }
-  *shmaddr = clk; /* initialize shared memory */
+  clockPage->clk = clk; /* initialize shared memory */
+  clockPage->events = 0;
+  clockPage->sentThrough = -1;
+  clockPage->handledUpTo = -1;
+  struct timespec next;
+  clock_gettime(CLOCK_MONOTONIC, &next);
   while (1) {
-    sleep(1);
-    (*shmaddr)++;
+    if (period > 0) {
+      /* Sleep until an absolute deadline so the period does not drift */
+      next.tv_nsec += (period % 1000000) * 1000;
+      next.tv_sec += period / 1000000 + next.tv_nsec / 1000000000;
+      next.tv_nsec %= 1000000000;
+      clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    waitAcks(clk);
+#ifdef SCHED_PROBES
+    clockPage->tickTime = Probe_now();
+#endif
+    __atomic_store_n(&clockPage->clk, ++clk, __ATOMIC_RELEASE);
+    /* Wake up everyone sleeping on the clock */
+    notifyEvent();
   }
 }
@@ -0,0 +1,88 @@
+/**
+ * @file converter.c
+ * @brief Converts a processes file between the text and the binary format.
+ *
+ * By default the output is written in the format the input is not in.
+ */
+
+#include "headers.h"
+
+#include "Workload.h"
+
+/*************** Global Variables ***************/
+static const char* inputName;   // NOLINT
+static const char* outputName;  // NOLINT
+static int format = -1;         // NOLINT
+/************************************************/
+
+/************* Function Definitions *************/
+void usage(const char* program);
+void parseOptions(int argc, char* argv[]);
+/************************************************/
+
+int main(int argc, char* argv[]) {
+  parseOptions(argc, argv);
+  Workload input;
+  Workload_open(&input, inputName);
+  bool binary = format == -1 ? (bool)!input.binary : (bool)format;
+  WorkloadWriter output;
+  WorkloadWriter_open(&output, outputName, binary);
+  struct ProcessRecord record;
+  int lastArrival = INT_MIN;
+  while (Workload_next(&input, &record)) {
+    if (record.arrivalTime < lastArrival) {
+      fprintf(stderr, "Process %d arrives before the one preceding it\n",
+              record.id);
+      exit(-1);
+    }
+    lastArrival = record.arrivalTime;
+    WorkloadWriter_write(&output, &record);
+  }
+  Workload_close(&input);
+  WorkloadWriter_close(&output);
+  printf("%lld processes written in %s format, arrivals from %d to %d\n",
+         output.header.count, binary ? "binary" : "text",
+         output.header.minArrival, output.header.maxArrival);
+  return 0;
+}
+
+/**
+ * @brief Prints how to run the converter and exits.
+ *
+ * @param program Name of the program.
+ */
+void usage(const char* program) {
+  fprintf(stderr, "Usage: %s [-t | -B] input output\n", program);
+  exit(-1);
+}
+
+/**
+ * @brief Parses the command line.
+ *
+ * - `-t` Write the text format.
+ * - `-B` Write the binary format.
+ * - `<input> <output>` Files to convert from and to.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ */
+void parseOptions(int argc, char* argv[]) {
+  int option;
+  while ((option = getopt(argc, argv, "tB")) != -1) {
+    switch (option) {
+      case 't':
+        format = false;
+        break;
+      case 'B':
+        format = true;
+        break;
+      default:
+        usage(argv[0]);
+    }
+  }
+  if (argc - optind != 2) {
+    usage(argv[0]);
+  }
+  inputName = argv[optind];
+  outputName = argv[optind + 1];
+}
@@ -0,0 +1,249 @@
+/**
+ * @file decoder.c
+ * @brief Turns a binary trace of the scheduler or the simulator into text.
+ *
+ * The scheduling events go to the scheduler log, in the same lines the
+ * scheduler prints when it runs without a trace, and the allocations and
+ * releases of memory go to the memory log. Every record can also be written
+ * as a line of CSV.
+ */
+
+#include "headers.h"
+
+#include "Engine.h"
+
+/******************** MACROS ********************/
+#define __SCHEDULER_LOG__ "scheduler.log" /**< Default scheduler log */
+#define __MEMORY_LOG__ "memory.log"       /**< Default memory log */
+#define __OUTPUT_BUFFER__ (1 << 20)       /**< Buffer of every output file */
+/************************************************/
+
+/*************** Global Variables ***************/
+static const char* traceName;                          // NOLINT
+static const char* schedulerName = __SCHEDULER_LOG__;  // NOLINT
+static const char* memoryName = __MEMORY_LOG__;        // NOLINT
+static const char* csvName;                            // NOLINT
+/************************************************/
+
+/**
+ * @brief Name of every kind of event in the CSV.
+ */
+static const char* const kindNames[_TRACE_KINDS] = {
+    "receive", "reject", "start", "resume", "stop", "remaining", "finish"};
+
+/************* Function Definitions *************/
+void usage(const char* program);
+void parseOptions(int argc, char* argv[]);
+FILE* openOutput(const char* name);
+void writeScheduler(FILE* out, const struct TraceRecord* r, int cpus);
+void writeMemory(FILE* out, const struct TraceRecord* r);
+void writeCSV(FILE* out, const struct TraceRecord* r);
+/************************************************/
+
+int main(int argc, char* argv[]) {
+  parseOptions(argc, argv);
+  int fd = open(traceName, O_RDONLY);
+  if (fd == -1) {
+    perror("Error opening the trace");
+    exit(-1);
+  }
+  struct stat info;
+  if (fstat(fd, &info) == -1) {
+    perror("Error reading the trace");
+    exit(-1);
+  }
+  size_t size = (size_t)info.st_size;
+  if (size < sizeof(struct TraceHeader)) {
+    fprintf(stderr, "%s: not a trace\n", traceName);
+    exit(-1);
+  }
+  void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    perror("Error mapping the trace");
+    exit(-1);
+  }
+  close(fd);
+  const struct TraceHeader* header = (const struct TraceHeader*)data;
+  long long capacity = header->capacity;
+  long long head = header->head;
+  long long count = head < capacity ? head : capacity;
+  if (memcmp(header->magic, TRACE_MAGIC, 4) != 0 ||
+      header->version != TRACE_VERSION ||
+      header->recordSize != sizeof(struct TraceRecord) || capacity <= 0 ||
+      (capacity & (capacity - 1)) != 0 || head < 0 ||
+      size < Trace_bytes(count)) {
+    fprintf(stderr, "%s: unsupported or truncated trace\n", traceName);
+    exit(-1);
+  }
+  madvise(data, size, MADV_SEQUENTIAL);
+  const struct TraceRecord* records = (const struct TraceRecord*)(header + 1);
+  if (head > capacity) {
+    fprintf(stderr, "%lld records were overwritten, the log starts at %d\n",
+            head - capacity, records[head & (capacity - 1)].tick);
+  }
+  FILE* scheduler = openOutput(schedulerName);
+  FILE* memory = openOutput(memoryName);
+  FILE* csv = csvName == NULL ? NULL : openOutput(csvName);
+  fprintf(scheduler, "%s\n", Engine_banner(header->algo));
+  if (csv != NULL) {
+    fprintf(csv, "tick,event,cpu,id,remaining,wait,memory,offset,block\n");
+  }
+  for (long long i = head - count; i < head; i++) {
+    const struct TraceRecord* r = &records[i & (capacity - 1)];
+    if (r->kind >= _TRACE_KINDS) {
+      fprintf(stderr, "%s: unknown event kind %d\n", traceName, r->kind);
+      exit(-1);
+    }
+    writeScheduler(scheduler, r, header->cpus);
+    writeMemory(memory, r);
+    if (csv != NULL) {
+      writeCSV(csv, r);
+    }
+  }
+  fclose(scheduler);
+  fclose(memory);
+  if (csv != NULL) {
+    fclose(csv);
+  }
+  munmap(data, size);
+  printf("%lld records decoded\n", count);
+  return 0;
+}
+
+/**
+ * @brief Prints how to run the decoder and exits.
+ *
+ * @param program Name of the program.
+ */
+void usage(const char* program) {
+  fprintf(stderr,
+          "Usage: %s [-s scheduler_log] [-m memory_log] [-c csv] trace\n",
+          program);
+  exit(-1);
+}
+
+/**
+ * @brief Parses the command line.
+ *
+ * - `-s <file>` Scheduler log (default scheduler.log).
+ * - `-m <file>` Memory log (default memory.log).
+ * - `-c <file>` CSV of every record (default none).
+ * - `<trace>` Trace to decode.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ */
+void parseOptions(int argc, char* argv[]) {
+  int option;
+  while ((option = getopt(argc, argv, "s:m:c:")) != -1) {
+    switch (option) {
+      case 's':
+        schedulerName = optarg;
+        break;
+      case 'm':
+        memoryName = optarg;
+        break;
+      case 'c':
+        csvName = optarg;
+        break;
+      default:
+        usage(argv[0]);
+    }
+  }
+  if (argc - optind != 1) {
+    usage(argv[0]);
+  }
+  traceName = argv[optind];
+}
+
+/**
+ * @brief Creates an output file with a large buffer.
+ *
+ * @param name Path of the file.
+ * @return The open file.
+ */
+FILE* openOutput(const char* name) {
+  FILE* out = fopen(name, "w");
+  if (out == NULL) {
+    perror(name);
+    exit(-1);
+  }
+  setvbuf(out, NULL, _IOFBF, __OUTPUT_BUFFER__);
+  return out;
+}
+
+/**
+ * @brief Writes the scheduler log line of a record.
+ *
+ * @param out The scheduler log.
+ * @param r Pointer to the record.
+ * @param cpus Number of CPUs of the run; the CPU of an event is only written
+ * when there is more than one.
+ */
+void writeScheduler(FILE* out, const struct TraceRecord* r, int cpus) {
+  switch (r->kind) {
+    case _TRACE_RECEIVE:
+      fprintf(out, "At time = %d, received process with ID = %d\n", r->tick,
+              r->id);
+      return;
+    case _TRACE_REJECT:
+      fprintf(out,
+              "At time = %d, rejected process with ID = %d, needs %d bytes\n",
+              r->tick, r->id, r->memory);
+      return;
+    case _TRACE_START:
+      fprintf(out, "At time = %d, new process with ID = %d started running",
+              r->tick, r->id);
+      break;
+    case _TRACE_RESUME:
+      fprintf(out, "At time = %d, process with ID = %d resumed", r->tick,
+              r->id);
+      break;
+    case _TRACE_STOP:
+      fprintf(out, "At time = %d, process with ID = %d stopped", r->tick,
+              r->id);
+      break;
+    case _TRACE_REMAINING:
+      fprintf(out, "At time = %d, ID = %d, remaining time = %d", r->tick,
+              r->id, r->remaining);
+      break;
+    default:
+      fprintf(out, "At time = %d, process with ID = %d, has finished",
+              r->tick, r->id);
+      break;
+  }
+  if (cpus > 1) {
+    fprintf(out, " on CPU %d", r->cpu);
+  }
+  fputc('\n', out);
+}
+
+/**
+ * @brief Writes the memory log line of a record, if it allocated or freed
+ * memory.
+ *
+ * @param out The memory log.
+ * @param r Pointer to the record.
+ */
+void writeMemory(FILE* out, const struct TraceRecord* r) {
+  if (r->kind != _TRACE_START && r->kind != _TRACE_FINISH) {
+    return;
+  }
+  unsigned long long end = r->offset + (1ULL << r->order) - 1;
+  fprintf(out, "At time = %d, %s %d bytes for process %d from %llu to %llu\n",
+          r->tick, r->kind == _TRACE_START ? "allocated" : "freed", r->memory,
+          r->id, r->offset, end);
+}
+
+/**
+ * @brief Writes a record as a line of CSV.
+ *
+ * @param out The CSV file.
+ * @param r Pointer to the record.
+ */
+void writeCSV(FILE* out, const struct TraceRecord* r) {
+  bool block = (bool)(r->kind == _TRACE_START || r->kind == _TRACE_FINISH);
+  fprintf(out, "%d,%s,%d,%d,%d,%d,%d,%llu,%llu\n", r->tick,
+          kindNames[r->kind], r->cpu, r->id, r->remaining, r->wait, r->memory,
+          r->offset, block ? 1ULL << r->order : 0ULL);
+}
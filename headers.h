@@ -1,15 +1,23 @@
 #include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <math.h>
+#include <sched.h>
 #include <signal.h>
 #include <stdio.h>  //if you don't use scanf/printf change this include
 #include <stdlib.h>
+#include <string.h>
 #include <sys/file.h>
 #include <sys/ipc.h>
-#include <sys/msg.h>
+#include <sys/mman.h>
 #include <sys/sem.h>
 #include <sys/shm.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 typedef short bool;
 #define true 1
@@ -17,31 +25,115 @@ typedef short bool;
 
 #include "DEFS.h"
 #include "Data_Structures/CircQueue.h"
+#include "Data_Structures/FairTree.h"
+#include "Data_Structures/Histogram.h"
+#include "Data_Structures/LevelQueue.h"
 #include "Data_Structures/PrioQueue.h"
-#include "Data_Structures/Queue.h"
+#include "Data_Structures/MemQueue.h"
+#include "Data_Structures/SPSCRing.h"
+#include "Probes.h"
 #include "MemoryManager.h"
+#include "Trace.h"
 
 #define SHKEY 300
 
+/*
+ * Layout of the shared memory of the clock. Every change of it bumps events,
+ * which is the futex word the clients sleep on, so nobody has to spin.
+ * The clock only moves past a time step once both the generator and the
+ * scheduler acknowledged it, so it never runs ahead of them.
+ */
+typedef struct ClockPage {
+  int clk;            /* Current time step */
+  int events;         /* Bumped on every change of the page */
+  int sentThrough;    /* Last time step whose processes were all sent */
+  int handledUpTo;    /* Last time step the scheduler is done with */
+  long long tickTime; /* CLOCK_MONOTONIC of the last tick, with probes */
+} ClockPage;
+
 ///==============================
-int *shmaddr;  // NOLINT
+ClockPage *clockPage;  // NOLINT
 //===============================
 
-int getClk() { return *shmaddr; }
+int getClk() { return __atomic_load_n(&clockPage->clk, __ATOMIC_ACQUIRE); }
+
+/*
+ * Returns the event counter; pass it to waitEvent after checking for work so
+ * that an event arriving in between is not missed.
+ */
+int getEvents() {
+  return __atomic_load_n(&clockPage->events, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * Bumps the event counter and wakes up every process sleeping on it.
+ */
+void notifyEvent() {
+  __atomic_add_fetch(&clockPage->events, 1, __ATOMIC_RELEASE);
+  syscall(SYS_futex, &clockPage->events, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/*
+ * Sleeps until the event counter differs from seen.
+ */
+void waitEvent(int seen) {
+  while (getEvents() == seen) {
+    syscall(SYS_futex, &clockPage->events, FUTEX_WAIT, seen, NULL, NULL, 0);
+  }
+}
+
+/*
+ * Returns the last time step whose processes were all sent.
+ */
+int getSent() {
+  return __atomic_load_n(&clockPage->sentThrough, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * Called by the generator once every process arriving up to clk was sent.
+ */
+void ackSent(int clk) {
+  __atomic_store_n(&clockPage->sentThrough, clk, __ATOMIC_RELEASE);
+  notifyEvent();
+}
+
+/*
+ * Called by the scheduler once it is done with the time step clk.
+ */
+void ackClk(int clk) {
+  if (__atomic_load_n(&clockPage->handledUpTo, __ATOMIC_ACQUIRE) < clk) {
+    __atomic_store_n(&clockPage->handledUpTo, clk, __ATOMIC_RELEASE);
+    notifyEvent();
+  }
+}
+
+/*
+ * Sleeps until the clock reaches the given time step and returns the clock.
+ */
+int waitClk(int until) {
+  int seen = getEvents();
+  int clk = getClk();
+  while (clk < until) {
+    waitEvent(seen);
+    seen = getEvents();
+    clk = getClk();
+  }
+  return clk;
+}
 
 /*
  * All process call this function at the beginning to establish communication
  * between them and the clock module.
  */
 void initClk() {
-  int shmid = shmget(SHKEY, 4, 0444);
+  int shmid = shmget(SHKEY, sizeof(ClockPage), 0444);
   while ((int)shmid == -1) {
     // Make sure that the clock exists
     printf("Wait! The clock not initialized yet!\n");
     sleep(1);
-    shmid = shmget(SHKEY, 4, 0444);
+    shmid = shmget(SHKEY, sizeof(ClockPage), 0444);
   }
-  shmaddr = (int *)shmat(shmid, (void *)0, 0);
+  clockPage = (ClockPage *)shmat(shmid, (void *)0, 0);
 }
 
 /*
@@ -52,8 +144,8 @@ void initClk() {
  */
 
 void destroyClk(bool terminateAll) {
-  shmdt(shmaddr);
+  shmdt(clockPage);
   if (terminateAll) {
     killpg(getpgrp(), SIGINT);
   }
-}
\ No newline at end of file
+}
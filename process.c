@@ -1,6 +1,171 @@
-int main(int agrc, char* argv[]) {
-  while (1)
-    ;
+/**
+ * @file process.c
+ * @brief Simulated process, run as a worker of the scheduler's pool.
+ *
+ * The worker waits on its WorkerSlot for a process to run, runs it until the
+ * scheduler releases it, and waits for the next one, until told to exit.
+ * While it runs a process, it publishes the remaining time of the process in
+ * its slot at every time step, and in between it either sleeps on the clock
+ * or runs a synthetic kernel:
+ * - `sleep` Uses no CPU at all (default).
+ * - `cpu` Spins on arithmetic.
+ * - `memory` Walks a buffer of the given size one cache line at a time.
+ */
 
+#include "headers.h"
+
+/******************** MACROS ********************/
+#define __SHM_ID__ 1                       /**< Argument of the slots segment */
+#define __SLOT_ID__ 2                      /**< Argument of the slot index */
+#define __KERNEL_ID__ 3                    /**< Argument of the kernel */
+#define __KERNEL_BYTES_ID__ 4              /**< Argument of the buffer size */
+#define __DEFAULT_KERNEL_BYTES__ (1 << 23) /**< Buffer of the memory kernel */
+#define __KERNEL_CHUNK__ 4096              /**< Work between two clock checks */
+#define __CACHE_LINE__ 64                  /**< Stride of the memory kernel */
+/************************************************/
+
+/**
+ * @brief Work done between two time steps.
+ */
+typedef enum Kernel { _KERNEL_SLEEP, _KERNEL_CPU, _KERNEL_MEMORY } Kernel;
+
+/*************** Global Variables ***************/
+static Kernel kernel;          // NOLINT
+static unsigned char* buffer;  // NOLINT
+static size_t bufferSize;      // NOLINT
+static size_t cursor;          // NOLINT
+/************************************************/
+
+/**
+ * @brief Sleeps until the sequence number of the slot moves past a value.
+ *
+ * @param slot Pointer to the slot.
+ * @param seen Last sequence number handled.
+ * @return The new sequence number.
+ */
+int waitCommand(WorkerSlot* slot, int seen) {
+  int seq;
+  while ((seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE)) == seen) {
+    syscall(SYS_futex, &slot->seq, FUTEX_WAIT, seen, NULL, NULL, 0);
+  }
+  return seq;
+}
+
+/**
+ * @brief Publishes the remaining time of the process at the current time step
+ * and wakes the scheduler if it waits for it.
+ *
+ * @param slot Pointer to the slot.
+ */
+void publishProgress(WorkerSlot* slot) {
+  int clk = getClk();
+  slot->remaining = slot->base - (clk - slot->since);
+  __atomic_store_n(&slot->clk, clk, __ATOMIC_RELEASE);
+  syscall(SYS_futex, &slot->clk, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+/**
+ * @brief Runs a chunk of the synthetic kernel.
+ */
+void runKernel(void) {
+  if (kernel == _KERNEL_CPU) {
+    static volatile unsigned int sink; /**< Keeps the loop from being cut */
+    unsigned int x = sink;
+    for (int i = 0; i < __KERNEL_CHUNK__; i++) {
+      x = x * 1664525u + 1013904223u;
+    }
+    sink = x;
+  } else {
+    for (int i = 0; i < __KERNEL_CHUNK__; i++) {
+      buffer[cursor]++;
+      cursor += __CACHE_LINE__;
+      if (cursor >= bufferSize) {
+        cursor = 0;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Runs the process until the scheduler gives the next command.
+ *
+ * @param slot Pointer to the slot.
+ * @param seen Sequence number of the run command.
+ */
+void runProcess(WorkerSlot* slot, int seen) {
+  while (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == seen) {
+    /* Read the event counter before the clock so no tick is missed */
+    int events = getEvents();
+    publishProgress(slot);
+    if (kernel == _KERNEL_SLEEP) {
+      waitEvent(events);
+      continue;
+    }
+    while (getEvents() == events &&
+           __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seen) {
+      runKernel();
+    }
+  }
+}
+
+/**
+ * @brief Sets up the kernel named on the command line.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ */
+void parseKernel(int argc, char* argv[]) {
+  const char* name = argc > __KERNEL_ID__ ? argv[__KERNEL_ID__] : "sleep";
+  if (strcmp(name, "sleep") == 0) {
+    kernel = _KERNEL_SLEEP;
+  } else if (strcmp(name, "cpu") == 0) {
+    kernel = _KERNEL_CPU;
+  } else if (strcmp(name, "memory") == 0) {
+    kernel = _KERNEL_MEMORY;
+    bufferSize = argc > __KERNEL_BYTES_ID__
+                     ? parseSize(argv[__KERNEL_BYTES_ID__])
+                     : __DEFAULT_KERNEL_BYTES__;
+    if (bufferSize < __CACHE_LINE__) {
+      bufferSize = __CACHE_LINE__;
+    }
+    buffer = (unsigned char*)calloc(bufferSize, 1);
+    if (buffer == NULL) {
+      perror("Error in allocating the kernel buffer");
+      exit(-1);
+    }
+  } else {
+    fprintf(stderr, "Unknown kernel %s\n", name);
+    exit(-1);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc <= __SLOT_ID__) {
+    fprintf(stderr, "Usage: %s shmid slot [sleep|cpu|memory] [bytes]\n",
+            argv[0]);
+    exit(-1);
+  }
+  parseKernel(argc, argv);
+  initClk();
+  WorkerSlot* slots = (WorkerSlot*)shmat(atoi(argv[__SHM_ID__]), (void*)0, 0);
+  if ((long)slots == -1) {
+    perror("Error in attaching the worker pool");
+    exit(-1);
+  }
+  WorkerSlot* slot = &slots[atoi(argv[__SLOT_ID__])];
+  int seen = 0;
+  while (1) {
+    seen = waitCommand(slot, seen);
+    int command = slot->command;
+    if (command == _WORKER_EXIT) {
+      break;
+    }
+    if (command == _WORKER_RUN) {
+      runProcess(slot, seen);
+    }
+  }
+  free(buffer);
+  shmdt(slots);
+  destroyClk(false);
   return 0;
 }
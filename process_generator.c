@@ -6,96 +6,159 @@
 
 #include "headers.h"
 
+#include "Workload.h"
+
 /******************** MACROS ********************/
 #define __PROCESSES_FILE__ "processes.txt" /**< Default processes file */
 /************************************************/
 
 /*************** Global Variables ***************/
-static int processesNum; /**< Number of processes */          // NOLINT
-static PCB* pcbArray; /**< Array of PCBs */                   // NOLINT
+static const char* fileName; /**< Processes file name */      // NOLINT
+static Workload workload; /**< Processes file */              // NOLINT
 static int algo; /**< Chosen scheduling algorithm */          // NOLINT
 static int quantumSize; /**< Quantum size for Round Robin */  // NOLINT
-static int msg_id; /**< Message queue ID */                   // NOLINT
+static int ring_id; /**< Arrivals ring shared memory ID */    // NOLINT
+static SPSC_Ring* ring; /**< Arrivals ring */                 // NOLINT
+static char* memorySize; /**< Memory size option */           // NOLINT
+static char* minBlockSize; /**< Minimum block size option */  // NOLINT
+static char* tickPeriod; /**< Clock tick period option */     // NOLINT
+static char* workers; /**< Worker pool size option */         // NOLINT
+static char* kernel; /**< Worker kernel option */             // NOLINT
+static char* kernelBytes; /**< Memory kernel size option */   // NOLINT
+static char* cpus; /**< Number of CPUs option */              // NOLINT
+static bool pin; /**< Pin the workers to host CPUs */         // NOLINT
+static char* levels; /**< MLFQ quanta option */               // NOLINT
+static char* boostPeriod; /**< MLFQ boost period option */    // NOLINT
+static char* latency; /**< CFS target latency option */       // NOLINT
+static char* granularity; /**< CFS granularity option */      // NOLINT
+static char* traceName; /**< Binary trace option */           // NOLINT
 /************************************************/
 
 /************* Function Definitions *************/
 void clearResources(int);
-int countLines(FILE* file);
-void readFile(void);
+void parseArguments(int argc, char* argv[]);
+void openFile(void);
 void getAlgorithm(void);
+void createRing(void);
 void forkClkandScheduler(void);
 void sendProcesses(void);
 /************************************************/
 
 int main(int argc, char* argv[]) {
   signal(SIGINT, clearResources);
-  // 1. Read the input files.
-  readFile();
+  parseArguments(argc, argv);
+  // 1. Open the input file.
+  openFile();
   // 2. Ask the user for the chosen scheduling algorithm and its parameters
   getAlgorithm();
-  // 3. Initiate and create the scheduler and clock processes.
+  // 3. Create the ring the processes are sent through.
+  createRing();
+  // 4. Initiate and create the scheduler and clock processes.
   forkClkandScheduler();
-  // 4. Use this function after creating the clock process to initialize clock
+  // 5. Use this function after creating the clock process to initialize clock
   initClk();
-  // 5. Send the information to the scheduler at the appropriate time.
+  // 6. Send the information to the scheduler at the appropriate time.
   sendProcesses();
-  // 6. Clear clock resources
+  // 7. Clear clock resources
   destroyClk(true);
 }
 
 /**
- * @brief Counts the number of lines in a given file.
+ * @brief Parses the command line options, which are forwarded to the
+ * scheduler and the clock.
+ *
+ * - `-f <file>` Processes file, in text or binary format (default
+ *   processes.txt).
+ * - `-m <size>` Size of the simulated memory, e.g. 1024, 64M or 1T.
+ * - `-b <size>` Minimum block size of the buddy allocator.
+ * - `-w <count>` Number of workers the scheduler forks up front.
+ * - `-k <kernel>` What a running process does: sleep, cpu or memory.
+ * - `-K <size>` Buffer walked by the memory kernel, e.g. 64M.
+ * - `-c <count>` Number of CPUs the scheduler schedules on (default 1).
+ * - `-p` Pin the workers running on a CPU to a host CPU.
+ * - `-l <quanta>` MLFQ quantum of every level from the top one, e.g. 2,4,8.
+ * - `-B <period>` Time steps between two MLFQ boosts, 0 to never boost.
+ * - `-L <latency>` CFS target latency in time steps.
+ * - `-G <granularity>` CFS minimum time slice.
+ * - `-T <file>` Binary trace the scheduler records its events in.
+ * - `-t <usec>` Tick period of the clock in microseconds (default 1000000);
+ *   0 ticks as fast as the generator and the scheduler keep up.
  *
- * @param file Pointer to the file to be counted.
- * @return Number of lines in the file.
+ * @param argc Argument count.
+ * @param argv Argument vector.
  */
-int countLines(FILE* file) {
-  int count = 0;
-  char buffer[50];
-  while (fgets(buffer, sizeof(buffer), file)) {
-    count++;
+void parseArguments(int argc, char* argv[]) {
+  fileName = __PROCESSES_FILE__;
+  int option;
+  while ((option = getopt(argc, argv, "f:m:b:t:w:k:K:c:pl:B:L:G:T:")) != -1) {
+    switch (option) {
+      case 'f':
+        fileName = optarg;
+        break;
+      case 'm':
+        memorySize = optarg;
+        break;
+      case 'b':
+        minBlockSize = optarg;
+        break;
+      case 't':
+        tickPeriod = optarg;
+        break;
+      case 'w':
+        workers = optarg;
+        break;
+      case 'k':
+        kernel = optarg;
+        break;
+      case 'K':
+        kernelBytes = optarg;
+        break;
+      case 'c':
+        cpus = optarg;
+        break;
+      case 'p':
+        pin = true;
+        break;
+      case 'l':
+        levels = optarg;
+        break;
+      case 'B':
+        boostPeriod = optarg;
+        break;
+      case 'L':
+        latency = optarg;
+        break;
+      case 'G':
+        granularity = optarg;
+        break;
+      case 'T':
+        traceName = optarg;
+        break;
+      default:
+        fprintf(stderr,
+                "Usage: %s [-f file] [-m memory_size] [-b min_block_size] "
+                "[-t tick_usec] [-w workers] [-k kernel] [-K kernel_size] "
+                "[-c cpus] [-p] [-l mlfq_quanta] [-B mlfq_boost] "
+                "[-L cfs_latency] [-G cfs_granularity] [-T trace]\n",
+                argv[0]);
+        exit(-1);
+    }
   }
-  return count;
 }
 
 /**
- * @brief Reads process information from a file and initializes PCBs.
+ * @brief Opens the processes file, in text or binary format.
+ *
+ * Only the first process is read here; the rest of the file is read while
+ * the processes are sent, only as far as the clock has gone.
  */
-void readFile(void) {
-  FILE* file = fopen(__PROCESSES_FILE__, "r");
-  if (file == NULL) {
-    perror("Error opening file");
-    exit(-1);
-  }
-  processesNum = countLines(file) - 1;
-  pcbArray = (PCB*)malloc(processesNum * sizeof(PCB));  // NOLINT
-  if (pcbArray == NULL) {
-    perror("Memory allocation failed");
-    fclose(file);
-    exit(-1);
-  }
-  char buffer[50];
-  int index = 0;
-  fseek(file, 0, SEEK_SET);
-  fgets(buffer, sizeof(buffer), file);
-  // Read and parse each PCB line
-  while (fgets(buffer, sizeof(buffer), file)) {
-    sscanf(buffer, "%d %d %d %d %d", &pcbArray[index].id,  // NOLINT
-           &pcbArray[index].arrivalTime, &pcbArray[index].runTime,
-           &pcbArray[index].prio, &pcbArray[index].memory);
-    pcbArray[index].PID = 0;
-    pcbArray[index].startTime = 0;
-    pcbArray[index].endTime = 0;
-    pcbArray[index].state = _UNKNOWN;
-    index++;
-  }
-}
+void openFile(void) { Workload_open(&workload, fileName); }
 
 /**
  * @brief Prompts user to select a scheduling algorithm and set its parameters.
  */
 void getAlgorithm(void) {
-  printf("[0]HPF   [1]SRTN   [2]RR\n");
+  printf("[0]HPF   [1]SRTN   [2]RR   [3]MLFQ   [4]CFS\n");
   printf("Please, choose a scheduling algo: ");
   scanf("%d", &algo);  // NOLINT
   switch (algo) {
@@ -109,6 +172,13 @@ void getAlgorithm(void) {
       printf("Enter the quantum size: ");
       scanf("%d", &quantumSize);  // NOLINT
       break;
+    case 3:
+      printf("Enter the quantum size of the top level: ");
+      scanf("%d", &quantumSize);  // NOLINT
+      break;
+    case 4:
+      quantumSize = 0;
+      break;
     default:
       perror("Wrong input algo");
       exit(-1);
@@ -126,7 +196,7 @@ void forkClkandScheduler(void) {
     perror("Error in forking of clock");
     exit(-1);
   } else if (clock_pid == 0) {
-    execl("./clk.out", "clk.out", NULL);
+    execl("./clk.out", "clk.out", tickPeriod, NULL);
     perror("Error in clock");
     exit(-1);
   }
@@ -137,48 +207,137 @@ void forkClkandScheduler(void) {
     exit(-1);
   } else if (sch_pid == 0) {
     // Convert parameters into char* and jump into scheduler
-    char pnum[5], algonum[5], quantumnum[5];
-    sprintf(pnum, "%d", processesNum);       // NOLINT
+    char algonum[12], quantumnum[12];
     sprintf(algonum, "%d", algo);            // NOLINT
     sprintf(quantumnum, "%d", quantumSize);  // NOLINT
-    execl("./scheduler.out", "scheduler.out", pnum, algonum, quantumnum, NULL);
+    char* args[32] = {"scheduler.out", algonum, quantumnum};
+    int argsNum = 3;
+    if (memorySize != NULL) {
+      args[argsNum++] = "-m";
+      args[argsNum++] = memorySize;
+    }
+    if (minBlockSize != NULL) {
+      args[argsNum++] = "-b";
+      args[argsNum++] = minBlockSize;
+    }
+    if (workers != NULL) {
+      args[argsNum++] = "-w";
+      args[argsNum++] = workers;
+    }
+    if (kernel != NULL) {
+      args[argsNum++] = "-k";
+      args[argsNum++] = kernel;
+    }
+    if (kernelBytes != NULL) {
+      args[argsNum++] = "-K";
+      args[argsNum++] = kernelBytes;
+    }
+    if (cpus != NULL) {
+      args[argsNum++] = "-c";
+      args[argsNum++] = cpus;
+    }
+    if (pin) {
+      args[argsNum++] = "-p";
+    }
+    if (levels != NULL) {
+      args[argsNum++] = "-l";
+      args[argsNum++] = levels;
+    }
+    if (boostPeriod != NULL) {
+      args[argsNum++] = "-B";
+      args[argsNum++] = boostPeriod;
+    }
+    if (latency != NULL) {
+      args[argsNum++] = "-L";
+      args[argsNum++] = latency;
+    }
+    if (granularity != NULL) {
+      args[argsNum++] = "-G";
+      args[argsNum++] = granularity;
+    }
+    if (traceName != NULL) {
+      args[argsNum++] = "-T";
+      args[argsNum++] = traceName;
+    }
+    args[argsNum] = NULL;
+    execv("./scheduler.out", args);
     perror("Error in scheduler");
     exit(-1);
   }
 }
 
 /**
- * @brief Sends processes to scheduler via message queue based on their arrival
- * time.
+ * @brief Creates the shared memory ring the processes are sent through,
+ * replacing a ring left over by a previous run.
  */
-void sendProcesses(void) {
+void createRing(void) {
   key_t key_id = ftok(__FILE_KEY_NAME__, __FILE_KEY_VAL__);
-  msg_id = msgget(key_id, 0666 | IPC_CREAT);
-  if (msg_id == -1) {
+  size_t size = SPSC_Ring_bytes(__RING_CAPACITY__);
+  ring_id = shmget(key_id, size, IPC_CREAT | IPC_EXCL | 0666);
+  if (ring_id == -1 && errno == EEXIST) {
+    shmctl(shmget(key_id, 0, 0666), IPC_RMID, NULL);
+    ring_id = shmget(key_id, size, IPC_CREAT | IPC_EXCL | 0666);
+  }
+  if (ring_id == -1) {
     perror("Error in create");
     exit(-1);
   }
-  struct msgbuff message;
-  message.mtype = __MSG_TYPE__;
-  int i = 0;
-  message.process = pcbArray[0];
-  while (i < processesNum) {
-    if (pcbArray[i].arrivalTime == getClk()) {
-      msgsnd(msg_id, &message, sizeof(message.process), !IPC_NOWAIT);
-      message.process = pcbArray[++i];
+  ring = (SPSC_Ring*)shmat(ring_id, (void*)0, 0);
+  if ((long)ring == -1) {
+    perror("Error in attaching the ring");
+    exit(-1);
+  }
+  SPSC_Ring_Init(ring, __RING_CAPACITY__);
+}
+
+/**
+ * @brief Sends processes to scheduler through the ring based on their arrival
+ * time.
+ *
+ * The processes arriving at a time step are pushed as one batch, which costs
+ * no system call; the scheduler is woken once per time step, or earlier if a
+ * burst fills the ring. The file is read one process ahead of the clock, and
+ * the processes of a binary file go from its mapping straight to the ring.
+ */
+void sendProcesses(void) {
+  while (workload.pending) {
+    int clk = getClk();
+    while (workload.pending && workload.next.arrivalTime <= clk) {
+      /* Send the processes of the time step as one batch, split only if it
+       * does not fit in the ring */
+      int count;
+      const ProcessRecord* batch =
+          Workload_take(&workload, clk, __RING_CAPACITY__ - 1, &count);
+      if (SPSC_Ring_free(ring) < (unsigned int)count + 1) {
+        /* Let the scheduler drain the ring before waiting for room */
+        notifyEvent();
+      }
+      SPSC_Ring_pushBatch(ring, clk, batch, count);
     }
+    if (!workload.pending) {
+      break;
+    }
+    /* Nothing arrives before the next arrival time, so acknowledge the time
+     * steps up to it and sleep until then instead of polling the clock */
+    int idle = workload.next.arrivalTime - 1;
+    ackSent(idle > clk ? idle : clk);
+    waitClk(workload.next.arrivalTime);
+  }
+  Workload_close(&workload);
+  /* Tell the scheduler that every process was sent */
+  ackSent(INT_MAX);
+  while (1) {
+    pause();
   }
-  while (1)
-    ;
 }
 
 /**
- * @brief Cleans up resources like message queue upon receiving SIGINT signal.
+ * @brief Cleans up resources like the ring upon receiving SIGINT signal.
  *
  * @param signum Signal number received.
  */
 void clearResources(int signum) {
-  msgctl(msg_id, IPC_RMID, NULL);
+  shmctl(ring_id, IPC_RMID, NULL);
   printf("IPC instances are destroyed\n");
   exit(0);
 }
@@ -0,0 +1,173 @@
+/**
+ * @file schedtop.c
+ * @brief Watches a running scheduler through its stats page.
+ *
+ * The page is attached read-only and polled at a fixed interval, so watching
+ * costs the scheduler nothing, however long the run. Every poll prints the
+ * clock, the counters, the queue depths, the process of every CPU and the
+ * free blocks of every order, until the scheduler finishes.
+ */
+
+#include "headers.h"
+
+#include "Engine.h"
+#include "StatsPage.h"
+
+/******************** MACROS ********************/
+#define __DEFAULT_INTERVAL__ 500 /**< Milliseconds between two polls */
+#define __CPUS_PER_LINE__ 6      /**< CPUs printed on a line */
+/************************************************/
+
+/*************** Global Variables ***************/
+static int interval = __DEFAULT_INTERVAL__;  // NOLINT
+static int polls;                            // NOLINT
+/************************************************/
+
+/**
+ * @brief Name of every algorithm.
+ */
+static const char* const algoNames[] = {"HPF", "SRTN", "RR", "MLFQ", "CFS"};
+
+/************* Function Definitions *************/
+void parseOptions(int argc, char* argv[]);
+const StatsPage* attachPage(void);
+void sleepFor(int milliseconds);
+void printPage(const StatsPage* page, double ticksPerSecond);
+/************************************************/
+
+int main(int argc, char* argv[]) {
+  parseOptions(argc, argv);
+  const StatsPage* page = attachPage();
+  StatsPage* copy = (StatsPage*)malloc(sizeof(StatsPage));
+  if (copy == NULL) {
+    perror("Error in allocating the copy");
+    exit(-1);
+  }
+  struct timespec last;
+  clock_gettime(CLOCK_MONOTONIC, &last);
+  int lastTick = -1;
+  for (int poll = 0; polls == 0 || poll < polls; poll++) {
+    StatsPage_read(page, copy);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed = (double)(now.tv_sec - last.tv_sec) +
+                     (double)(now.tv_nsec - last.tv_nsec) / 1e9;
+    double rate = lastTick >= 0 && elapsed > 0
+                      ? (double)(copy->tick - lastTick) / elapsed
+                      : 0.0;
+    last = now;
+    lastTick = copy->tick;
+    printPage(copy, rate);
+    if (copy->done) {
+      break;
+    }
+    sleepFor(interval);
+  }
+  free(copy);
+  shmdt(page);
+  return 0;
+}
+
+/**
+ * @brief Parses the command line.
+ *
+ * - `-i <ms>` Milliseconds between two polls (default 500).
+ * - `-n <count>` Number of polls, 0 to poll until the scheduler finishes
+ *   (default 0).
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ */
+void parseOptions(int argc, char* argv[]) {
+  int option;
+  while ((option = getopt(argc, argv, "i:n:")) != -1) {
+    switch (option) {
+      case 'i':
+        interval = atoi(optarg);
+        break;
+      case 'n':
+        polls = atoi(optarg);
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-i interval_ms] [-n polls]\n", argv[0]);
+        exit(-1);
+    }
+  }
+  if (interval < 1 || polls < 0) {
+    fprintf(stderr, "Invalid interval or number of polls\n");
+    exit(-1);
+  }
+}
+
+/**
+ * @brief Attaches the stats page read-only, waiting for the scheduler to
+ * create it.
+ *
+ * @return Pointer to the page.
+ */
+const StatsPage* attachPage(void) {
+  key_t key_id = ftok(__FILE_KEY_NAME__, __STATS_KEY_VAL__);
+  int shmid = shmget(key_id, 0, 0444);
+  if (shmid == -1) {
+    printf("Waiting for the scheduler...\n");
+    while (shmid == -1) {
+      sleepFor(interval);
+      shmid = shmget(key_id, 0, 0444);
+    }
+  }
+  const StatsPage* page = (const StatsPage*)shmat(shmid, (void*)0, SHM_RDONLY);
+  if ((long)page == -1) {
+    perror("Error in attaching the stats page");
+    exit(-1);
+  }
+  return page;
+}
+
+/**
+ * @brief Sleeps for a number of milliseconds.
+ *
+ * @param milliseconds The time to sleep.
+ */
+void sleepFor(int milliseconds) {
+  struct timespec duration = {milliseconds / 1000,
+                              (milliseconds % 1000) * 1000000L};
+  nanosleep(&duration, NULL);
+}
+
+/**
+ * @brief Prints a copy of the page, over the previous one on a terminal.
+ *
+ * @param page Pointer to the copy.
+ * @param ticksPerSecond Speed of the clock since the previous poll.
+ */
+void printPage(const StatsPage* page, double ticksPerSecond) {
+  if (isatty(STDOUT_FILENO)) {
+    printf("\033[H\033[J");
+  }
+  int running = 0;
+  for (int c = 0; c < page->cpus; c++) {
+    running += page->runningId[c] != -1;
+  }
+  printf("Time = %d (%.1f ticks/s), %s%s\n", page->tick, ticksPerSecond,
+         page->algo >= 0 && page->algo <= __CFS__ ? algoNames[page->algo] : "?",
+         page->done ? ", finished" : "");
+  printf("Finished = %d, rejected = %d, context switches = %lld\n",
+         page->finished, page->rejected, page->switches);
+  printf("Running = %d/%d, ready = %d, waiting for memory = %d\n", running,
+         page->cpus, page->ready, page->memoryWait);
+  for (int c = 0; c < page->cpus; c++) {
+    if (page->runningId[c] == -1) {
+      printf("CPU %4d: %8s", c, "idle");
+    } else {
+      printf("CPU %4d: %8d", c, page->runningId[c]);
+    }
+    printf((c + 1) % __CPUS_PER_LINE__ == 0 || c + 1 == page->cpus ? "\n"
+                                                                  : "  ");
+  }
+  printf("Free blocks:");
+  for (int k = page->minOrder; k <= page->maxOrder && k < MAX_ORDERS; k++) {
+    printf(" %zu:%lld", (size_t)1 << k, page->freeBlocks[k]);
+  }
+  printf("\n");
+  fflush(stdout);
+}
@@ -1,551 +1,448 @@
+#define _GNU_SOURCE /* sched_setaffinity */
 #include "headers.h"
 
+#include "Engine.h"
+#include "StatsPage.h"
+#include "WorkerPool.h"
+
 /******************** MACROS ********************/
-#define __PROCESS_NUMBER_ID__ 1
-#define __ALGORITHM_NUMBER_ID__ 2
-#define __QUANTUM_SIZE_ID__ 3
+#define __ALGORITHM_NUMBER_ID__ 1
+#define __QUANTUM_SIZE_ID__ 2
+#define __FIRST_OPTION_ID__ 3
+#define __DEFAULT_WORKERS__ 8
+#define __DEFAULT_KERNEL__ "sleep"
+#define __DEFAULT_KERNEL_BYTES__ "8M"
+#define __PERF_FILE__ "scheduler.perf"
+#define __PROBES_FILE__ "scheduler.probes"
 /************************************************/
 
 /*************** Global Variables ***************/
-static int processNumber;       // NOLINT
-static int algo;                // NOLINT
-static int quantumSize;         // NOLINT
-static int msg_id;              // NOLINT
-static ssize_t rec_val;         // NOLINT
-static struct msgbuff message;  // NOLINT
-static int receivedProcesses;   // NOLINT
+static int algo;                          // NOLINT
+static int quantumSize;                   // NOLINT
+static SPSC_Ring* ring;                   // NOLINT
+static ssize_t rec_val;                   // NOLINT
+static bool allReceived;                  // NOLINT
+static struct PCB* arrivals;              // NOLINT
+static int arrivalsCount;                 // NOLINT
+static int arrivalsCapacity;              // NOLINT
+static int arrivalsTick;                  // NOLINT
+static size_t memorySize;                 // NOLINT
+static size_t minBlockSize;               // NOLINT
+static int workers;                       // NOLINT
+static const char* kernel;                // NOLINT
+static const char* kernelBytes;           // NOLINT
+static int cpus;                          // NOLINT
+static bool pin;                          // NOLINT
+static const char* levels;                // NOLINT
+static int boostPeriod;                   // NOLINT
+static int latency;                       // NOLINT
+static int granularity;                   // NOLINT
+static const char* traceName;             // NOLINT
+static struct Trace trace;                // NOLINT
+static struct WorkerPool pool;            // NOLINT
+static struct Engine engine;              // NOLINT
+static StatsPage* stats;                  // NOLINT
+static int stats_id;                      // NOLINT
+#ifdef SCHED_PROBES
+static volatile sig_atomic_t dumpProbes;  // NOLINT
+#endif
 /************************************************/
 
 /************* Function Definitions *************/
-struct PCB rec_msg_queue(void);
-void HPF(void);
-void SRTN(void);
-void RR(void);
+void parseOptions(int argc, char* argv[]);
+void reserveArrivals(int count);
+int receiveProcesses(int oldClk);
+void assignWorker(struct PCB* process);
+void startProcess(struct PCB* process);
+void resumeProcess(struct PCB* process);
+void stopProcess(struct PCB* process);
+void releaseProcess(struct PCB* process);
+int progressProcess(struct PCB* process);
+#ifdef SCHED_PROBES
+void requestProbes(int signum);
+#endif
+void schedule(void);
 /************************************************/
 
 int main(int argc, char* argv[]) {
   /****************************** Initialization ******************************/
   initClk();
-  /* Initialize the message queue */
+#ifdef SCHED_PROBES
+  signal(SIGUSR1, requestProbes);
+#endif
+  /* Attach the ring created by the process generator */
   key_t key_id = ftok(__FILE_KEY_NAME__, __FILE_KEY_VAL__);
-  msg_id = msgget(key_id, 0666 | IPC_CREAT);
-  if (msg_id == -1) {
+  int ring_id = shmget(key_id, 0, 0666);
+  if (ring_id == -1) {
     perror("Error in create");
     exit(-1);
   }
+  ring = (SPSC_Ring*)shmat(ring_id, (void*)0, 0);
+  if ((long)ring == -1) {
+    perror("Error in attaching the ring");
+    exit(-1);
+  }
   /* Initialize the global variables */
-  processNumber = atoi(argv[__PROCESS_NUMBER_ID__]);
   algo = atoi(argv[__ALGORITHM_NUMBER_ID__]);
   quantumSize = atoi(argv[__QUANTUM_SIZE_ID__]);
-  initializeBuddyAllocator();
+  parseOptions(argc, argv);
+  initializeBuddyAllocator(memorySize, minBlockSize);
+  WorkerPool_Init(&pool, workers, kernel, kernelBytes);
+  Engine_Hooks hooks = {startProcess, resumeProcess, stopProcess,
+                        releaseProcess, progressProcess};
+  Engine_Init(&engine, algo, quantumSize, cpus, getClk(), hooks,
+              traceName == NULL);
+  Engine_setLevels(&engine, levels, boostPeriod);
+  Engine_setFair(&engine, latency, granularity);
+  if (traceName != NULL) {
+    Trace_open(&trace, traceName, algo, cpus);
+    Engine_setTrace(&engine, &trace);
+  }
+  stats = StatsPage_create(&stats_id);
+  StatsPage_publish(stats, &engine, false);
   /****************************************************************************/
 
-  /**************************** Algorithm Choosing ****************************/
-  if (algo == 0) {
-    /* Highest Priority First */
-    HPF();
-  } else if (algo == 1) {
-    /* Shortest Remaining Time Next */
-    SRTN();
-  } else if (algo == 2) {
-    /* Round Robin */
-    RR();
+  schedule();
+  free(arrivals);
+  WorkerPool_destroy(&pool);
+  if (traceName != NULL) {
+    Trace_close(&trace);
   }
-  /****************************************************************************/
+  Engine_printCPUs(&engine);
+  Engine_writePerf(&engine, __PERF_FILE__);
+  /* Readers still attached keep the page until they see it is done */
+  StatsPage_publish(stats, &engine, true);
+  shmdt(stats);
+  shmctl(stats_id, IPC_RMID, NULL);
+#ifdef SCHED_PROBES
+  Probe_write(__PROBES_FILE__);
+#endif
+  Engine_destroy(&engine);
 
+  printMemoryStats();
   // upon termination release the clock resources.
+  shmdt(ring);
   destroyClk(true);
 }
 
 /**
- * @brief Receive a process message from a message queue.
- *
- * This function attempts to receive a process message from a message queue
- * identified by `msg_id`. If a message is received successfully, it initializes
- * a PCB structure with the received process's parameters and increments the
- * count of received processes.
+ * @brief Parses the optional arguments following the positional ones.
  *
- * @details
- * - Uses `msgrcv` to receive a message from the message queue.
- * - Initializes a PCB structure with process parameters upon successful
- * receipt.
- * - Handles errors during the message reception process, including checking for
- *   the absence of messages (ENOMSG).
- *
- * @note
- * - Assumes the existence of a message queue identified by `msg_id`.
- * - Assumes a message structure (`message`) containing process parameters.
- * - Sets `pcb.id` to `-1` if no message is received or an error occurs.
+ * - `-m <size>` Size of the simulated memory (default TOTAL_MEMORY_SIZE).
+ * - `-b <size>` Minimum block size of the buddy allocator (default
+ *   MINIMUM_BLOCK_SIZE); smaller requests are served from slabs.
+ * - `-w <count>` Number of workers forked up front (default 8, at most
+ *   1024); the pool grows up to one worker per CPU.
+ * - `-k <kernel>` What a running process does between two time steps: sleep
+ *   (default), cpu or memory.
+ * - `-K <size>` Buffer walked by the memory kernel (default 8M).
+ * - `-c <count>` Number of CPUs (default 1), each with its own ready queue.
+ * - `-p` Pin the worker running on a CPU to a host CPU.
+ * - `-l <quanta>` MLFQ quantum of every level from the top one, e.g. 2,4,8
+ *   (default three levels doubling the quantum).
+ * - `-B <period>` Time steps between two MLFQ boosts, 0 to never boost
+ *   (default 100).
+ * - `-L <latency>` CFS target latency in time steps (default 6).
+ * - `-G <granularity>` CFS minimum time slice (default 1).
+ * - `-T <file>` Record the events in a binary trace instead of printing
+ *   them.
  *
- * @return struct PCB The PCB structure initialized with received process
- * parameters, if no received process, returns a process with id = -1.
+ * @param argc Argument count.
+ * @param argv Argument vector.
  */
-struct PCB rec_msg_queue(void) {
-  /* Create the returned structure */
-  struct PCB pcb;
-  pcb.id = -1;
-  rec_val = msgrcv(msg_id, &message, sizeof(message.process), __MSG_TYPE__,
-                   IPC_NOWAIT);
-  if (rec_val == -1) {
-    if (errno != ENOMSG) {
-      perror("Error in receiving process");
-      exit(-1);
+void parseOptions(int argc, char* argv[]) {
+  memorySize = TOTAL_MEMORY_SIZE;
+  minBlockSize = MINIMUM_BLOCK_SIZE;
+  workers = __DEFAULT_WORKERS__;
+  kernel = __DEFAULT_KERNEL__;
+  kernelBytes = __DEFAULT_KERNEL_BYTES__;
+  cpus = 1;
+  boostPeriod = -1;
+  optind = __FIRST_OPTION_ID__;
+  int option;
+  while ((option = getopt(argc, argv, "m:b:w:k:K:c:pl:B:L:G:T:")) != -1) {
+    switch (option) {
+      case 'm':
+        memorySize = parseSize(optarg);
+        break;
+      case 'b':
+        minBlockSize = parseSize(optarg);
+        break;
+      case 'w':
+        workers = atoi(optarg);
+        break;
+      case 'k':
+        kernel = optarg;
+        break;
+      case 'K':
+        kernelBytes = optarg;
+        break;
+      case 'c':
+        cpus = atoi(optarg);
+        break;
+      case 'p':
+        pin = true;
+        break;
+      case 'l':
+        levels = optarg;
+        break;
+      case 'B':
+        boostPeriod = atoi(optarg);
+        break;
+      case 'L':
+        latency = atoi(optarg);
+        break;
+      case 'G':
+        granularity = atoi(optarg);
+        break;
+      case 'T':
+        traceName = optarg;
+        break;
+      default:
+        exit(-1);
     }
-  } else {
-    /* Recieve the new process and initialize its parameters */
-    pcb.id = message.process.id;
-    pcb.arrivalTime = message.process.arrivalTime;
-    pcb.runTime = message.process.runTime;
-    pcb.prio = message.process.prio;
-    pcb.memory = message.process.memory;
-    /* Set unreceived data */
-    pcb.remainingTime = message.process.runTime;
-    pcb.state = _NEW;
-    pcb.waitTime = 0;
-    pcb.memPointer = NULL;
-    /* Increment received process number */
-    receivedProcesses++;
   }
-  return pcb;
+  if (cpus < 1 || cpus > __MAX_CPUS__) {
+    fprintf(stderr, "The number of CPUs must be from 1 to %d\n", __MAX_CPUS__);
+    exit(-1);
+  }
+  if (workers < 0 || workers > WORKER_POOL_MAX) {
+    fprintf(stderr, "The number of workers must be from 0 to %d\n",
+            WORKER_POOL_MAX);
+    exit(-1);
+  }
 }
 
 /**
- * @brief Highest Priority First (HPF) scheduling algorithm.
+ * @brief Makes sure the arrivals buffer can hold the given number of
+ * processes.
  *
- * This function implements the HPF scheduling algorithm using a priority queue.
- * It receives processes from a message queue, prioritizes them based on their
- * priority, and executes them accordingly using fork and exec.
+ * @param count Number of processes to be held.
+ */
+void reserveArrivals(int count) {
+  if (count <= arrivalsCapacity) {
+    return;
+  }
+  int newCapacity = arrivalsCapacity == 0 ? 64 : arrivalsCapacity;
+  while (newCapacity < count) {
+    newCapacity *= 2;
+  }
+  arrivals = (struct PCB*)realloc(arrivals,
+                                  newCapacity * sizeof(struct PCB));  // NOLINT
+  if (arrivals == NULL) {
+    perror("Error in allocating the arrivals");
+    exit(-1);
+  }
+  arrivalsCapacity = newCapacity;
+}
+
+/**
+ * @brief Receive the batch of processes sent for the current time step.
+ *
+ * This function takes every batch waiting in the ring shared with the process
+ * generator and copies its processes into `arrivals`. Once the generator has
+ * sent everything for the time step, the collected processes are handed over
+ * together, so the engine admits them in a single call.
  *
  * @details
- * - Initializes necessary variables and structures.
- * - Continuously receives processes until all processes are received and
- *   the priority queue is empty.
- * - Iterates in time steps (each second) and handles process forking,
- *   execution, and termination.
+ * - Uses `SPSC_Ring_peekBatch` and `SPSC_Ring_popBatch`, which need no system
+ *   call.
+ * - A time step with more processes than the ring holds comes in several
+ *   batches, which are joined before they are handed over.
+ * - Copies the sent process parameters into PCBs; the engine sets the rest
+ *   when the processes are admitted.
+ * - Receives nothing until the current time step of the clock was processed,
+ *   so processes arriving at a time step are handled after the step itself.
+ * - Acknowledges the time step to the clock once all its processes were sent
+ *   and received, which lets the clock move on.
+ * - Sets `allReceived` once the generator, which streams the processes file
+ *   and does not know its length in advance, marked every time step as sent
+ *   and nothing is left to hand over.
  *
  * @note
- * - Uses functions from Prio_Queue module for queue operations.
- * - Uses getClk() to get current clock time.
- * - Uses kill() to terminate processes.
+ * - Sets `rec_val` to `1` if processes were handed over, `-1` if there is
+ *   nothing to do until the next event and `0` if the ring was not checked.
  *
- * @warning
- * - Uses SIGKILL to forcefully terminate processes.
- *
- * @param None
- * @return None
+ * @param oldClk Last time step processed by the algorithm.
+ * @return Number of processes handed over at the start of `arrivals`.
  */
-void HPF(void) {
-  printf("============ SRTN ============\n");
-  /****************************** Initialization ******************************/
-  int oldClk = getClk();  /**< Clock counter */
-  struct PCB rec;         /**< PCB to receive processes */
-  struct Prio_Queue q;    /**< Priority queue to implement the algorithm */
-  struct PCB process;     /**< Process to be currently executed */
-  bool currently = false; /**< Currently running a process */
-  Prio_Queue_Init(&q);    /**< Initialize the priority queue */
-  /****************************************************************************/
-
-  while ((receivedProcesses < processNumber) || !Prio_Queue_isEmpty(&q) ||
-         (currently == true)) {
-    /***************************** Receive Process ****************************/
-    rec = rec_msg_queue();
-    if (rec.id != -1) {
-      Prio_Queue_enqueue(&q, rec.prio, rec);
-      /* Print Statement */
-      printf("At time = %d, received process with ID = %d\n", getClk(), rec.id);
-      if (currently == false) {
-        /* Dequeue the head of the queue (highest priority process) */
-        process = Prio_Queue_dequeue(&q);
-        if (process.id != -1) {
-          process.memPointer = allocate(process.memory);
-          if (process.memPointer == NULL) {
-            Prio_Queue_enqueue(&q, process.prio, process);
-          } else {
-            /* Fork new process */
-            int process_id = fork();
-            if (process_id == -1) {
-              perror("Error in forking of a process ");
-              exit(-1);
-            } else if (process_id == 0) {  // Child
-              execl("./process.out", "process.out", NULL);
-            } else {  // Parent
-              currently = true;
-              process.startTime = oldClk;
-              process.PID = process_id;
-              process.state = _RUNNING;
-              printf("At time = %d, new process with ID = %d started running\n",
-                     oldClk, process.id);
-            }
-          }
-        }
-      }
-    }
-    /**************************************************************************/
-
-    /******************************** TIME STEP *******************************/
-    if ((getClk() - oldClk) == 1) {
-      Prio_Queue_Inc_WaitingTime(&q, oldClk);
-      oldClk = getClk();
-
-      /************************** NEW PROCESS FORKING *************************/
-      if (currently == false) {
-        /* Dequeue the head of the queue (highest priority process) */
-        process = Prio_Queue_dequeue(&q);
-        if (process.id != -1) {
-          /* Fork new process */
-          process.memPointer = allocate(process.memory);
-          if (process.memPointer == NULL) {
-            Prio_Queue_enqueue(&q, process.prio, process);
-          } else {
-            int process_id = fork();
-            if (process_id == -1) {
-              perror("Error in forking of a process ");
-              exit(-1);
-            } else if (process_id == 0) {  // Child
-              execl("./process.out", "process.out", NULL);
-            } else {  // Parent
-              currently = true;
-              process.startTime = oldClk;
-              process.PID = process_id;
-              process.state = _RUNNING;
-              printf("At time = %d, new process with ID = %d started running\n",
-                     oldClk, process.id);
-            }
-          }
-        }
-      }
-      /************************************************************************/
-
-      /*************************** NORMAL PROCESSING **************************/
-      else {
-        process.remainingTime--;
-        /* Destroy the running process */
-        if (process.remainingTime == 0) {
-          currently = false;
-          process.endTime = oldClk;
-          kill(process.PID, SIGKILL);
-          deallocate(process.memPointer);
-          /* Print statement */
-          printf("At time = %d, process with ID = %d, has finished\n", oldClk,
-                 process.id);
-          /* Start new process */
-          /* Dequeue the head of the queue (highest priority process) */
-          process = Prio_Queue_dequeue(&q);
-          if (process.id != -1) {
-            /* Fork new process */
-            process.memPointer = allocate(process.memory);
-            if (process.memPointer == NULL) {
-              Prio_Queue_enqueue(&q, process.prio, process);
-            } else {
-              int process_id = fork();
-              if (process_id == -1) {
-                perror("Error in forking of a process ");
-                exit(-1);
-              } else if (process_id == 0) {  // Child
-                execl("./process.out", "process.out", NULL);
-              } else {  // Parent
-                currently = true;
-                process.startTime = oldClk;
-                process.PID = process_id;
-                process.state = _RUNNING;
-                printf(
-                    "At time = %d, new process with ID = %d started running\n",
-                    oldClk, process.id);
-              }
-            }
-          }
-        } else {
-          /* Print statement */
-          printf("At time = %d, ID = %d, remaining time = %d\n", oldClk,
-                 process.id, process.remainingTime);
-        }
-      }
-      /************************************************************************/
+int receiveProcesses(int oldClk) {
+  /* Read the clock before the sent step, and both before the ring */
+  int clk = getClk();
+  int sent = getSent();
+  if (clk - oldClk >= engine.timeStep) {
+    /* The ring was not checked, so the caller must not sleep yet */
+    rec_val = 0;
+    return 0;
+  }
+  struct BatchHeader header;
+  while (SPSC_Ring_peekBatch(ring, &header)) {
+    reserveArrivals(arrivalsCount + header.count);
+    for (int i = 0; i < header.count; i++) {
+      const struct ProcessRecord* record = SPSC_Ring_record(ring, i);
+      struct PCB* pcb = &arrivals[arrivalsCount++];
+      pcb->id = record->id;
+      pcb->arrivalTime = record->arrivalTime;
+      pcb->runTime = record->runTime;
+      pcb->prio = record->prio;
+      pcb->memory = record->memory;
     }
-    /**************************************************************************/
+    arrivalsTick = header.tick;
+    SPSC_Ring_popBatch(ring, &header);
   }
+  rec_val = -1;
+  if (sent < clk) {
+    /* More processes may still be sent for this time step */
+    return 0;
+  }
+  if (arrivalsCount == 0) {
+    /* The generator marks the end of the file as sent for ever */
+    allReceived = (bool)(sent == INT_MAX);
+    ackClk(clk);
+    return 0;
+  }
+  int count = arrivalsCount;
+  arrivalsCount = 0;
+  rec_val = 1;
+  return count;
 }
 
 /**
- * @brief Shortest Remaining Time Next (SRTN) scheduling algorithm.
- *
- * This function implements the SRTN scheduling algorithm using processes
- * received from a message queue. It manages process execution based on their
- * remaining time to complete, using process suspension and resumption to
- * ensure the shortest job is always running.
+ * @brief Runs a process that got a CPU on an idle worker of the pool.
  *
- * The function manages process forking, signaling (SIGSTOP, SIGCONT,
- * SIGKILL), and updates the state of each process in a priority queue.
- *
- * @details
- * - Initializes necessary variables and structures.
- * - Continuously receives processes until all processes are received and
- *   the priority queue is empty.
- * - Iterates in time steps (each second) and handles process forking,
- *   execution, and termination.
- *
- * @note
- * - Uses functions from Prio_Queue module for queue operations.
- * - Uses getClk() to get current clock time.
- * - Uses kill() to terminate processes.
+ * The worker counts the remaining time of the process from the engine step
+ * it got the CPU in, the same way the engine charges it.
  *
- * @warning
- * - Uses SIGKILL to forcefully terminate processes.
+ * @param process Pointer to the PCB of the process.
+ */
+void assignWorker(struct PCB* process) {
+  process->worker = WorkerPool_assign(&pool, process->id,
+                                      process->remainingTime, engine.oldClk);
+  if (pin) {
+    WorkerPool_pin(&pool, process->worker, process->cpu);
+  }
+  process->PID = pool.pids[process->worker];
+}
+
+/**
+ * @brief Starts a process for the engine on a worker of the pool.
  *
- * @param None
- * @return None
+ * @param process Pointer to the PCB of the process.
  */
-void SRTN(void) {
-  printf("============ SRTN ============\n");
-  /****************************** Initialization ******************************/
-  int oldClk = getClk();  /**< Clock counter */
-  struct PCB rec;         /**< PCB to receive processes */
-  struct Prio_Queue q;    /**< Priority queue to implement the algorithm */
-  struct PCB process;     /**< Process to be currently executed */
-  bool currently = false; /**< Currently running a process */
-  Prio_Queue_Init(&q);    /**< Initialize the priority queue */
-  process.id = -1;        /**< To disable unreasonable stopping */
-  /****************************************************************************/
+void startProcess(struct PCB* process) {
+  PROBE_BEGIN(begin);
+  assignWorker(process);
+  PROBE_END(_PROBE_START, begin);
+}
 
-  while ((receivedProcesses < processNumber) || !Prio_Queue_isEmpty(&q) ||
-         (currently == true)) {
-    /***************************** Receive Process ****************************/
-    rec = rec_msg_queue();
-    if (rec.id != -1) {
-      Prio_Queue_enqueue(&q, rec.remainingTime, rec);
-      /* Print Statement */
-      printf("At time = %d, received process with ID = %d\n", getClk(), rec.id);
-      if (currently == false) {
-        process = Prio_Queue_dequeue(&q);
-        process.memPointer = allocate(process.memory);
-        if (process.memPointer == NULL) {
-          Prio_Queue_enqueue(&q, process.remainingTime, process);
-        } else {
-          int process_id = fork();
-          if (process_id == -1) {
-            perror("Error in forking of a process ");
-            exit(-1);
-          } else if (process_id == 0) {  // Child
-            execl("./process.out", "process.out", NULL);
-          } else {  // Parent
-            currently = true;
-            process.startTime = oldClk;
-            process.PID = process_id;
-            process.state = _RUNNING;
-            printf("At time = %d, new process with ID = %d started running\n",
-                   oldClk, process.id);
-          }
-        }
-      }
-    }
-    /**************************************************************************/
+/**
+ * @brief Resumes a preempted process on an idle worker, not necessarily the
+ * one it ran on before.
+ *
+ * @param process Pointer to the PCB of the process.
+ */
+void resumeProcess(struct PCB* process) {
+  PROBE_BEGIN(begin);
+  assignWorker(process);
+  PROBE_END(_PROBE_RESUME, begin);
+}
 
-    /******************************** TIME STEP *******************************/
-    if (getClk() - oldClk == 1) {
-      Prio_Queue_Inc_WaitingTime(&q, oldClk);
-      oldClk = getClk();
-      /**************************** PAUSE RUNNING *****************************/
-      if (process.id != -1 && process.state == _RUNNING) {
-        currently = false;
-        /* Pause it from running */
-        kill(process.PID, SIGSTOP);
-        /* Decrement the remaining time */
-        process.remainingTime--;
-        if (process.remainingTime == 0) {
-          /* Kill the process */
-          kill(process.PID, SIGKILL);
-          /* Deallocate the memory */
-          deallocate(process.memPointer);
-          /* Print statement */
-          printf("At time = %d, process with ID = %d, has finished\n", oldClk,
-                 process.id);
-        } else {
-          /* Set its state to ready to be run */
-          process.state = _READY;
-          /* Insert it back into the queue */
-          Prio_Queue_enqueue(&q, process.remainingTime, process);
-          /* Print statement */
-          printf("At time = %d, ID = %d, remaining time = %d\n", oldClk,
-                 process.id, process.remainingTime);
-        }
-      }
-      /************************************************************************/
+/**
+ * @brief Preempts a running process, handing its worker back to the pool.
+ *
+ * @param process Pointer to the PCB of the process.
+ */
+void stopProcess(struct PCB* process) {
+  PROBE_BEGIN(begin);
+  WorkerPool_release(&pool, process->worker);
+  process->worker = -1;
+  PROBE_END(_PROBE_STOP, begin);
+}
 
-      /*************************** NORMAL PROCESSING **************************/
-      process = Prio_Queue_dequeue(&q);
-      if (process.id != -1) {
-        if (process.state == _READY) {
-          currently = true;
-          process.state = _RUNNING;
-          kill(process.PID, SIGCONT);
-        } else if (process.state == _NEW) {
-          process.memPointer = allocate(process.memory);
-          if (process.memPointer == NULL) {
-            Prio_Queue_enqueue(&q, process.remainingTime, process);
-          } else {
-            int process_id = fork();
-            if (process_id == -1) {
-              perror("Error in forking of a process ");
-              exit(-1);
-            } else if (process_id == 0) {  // Child
-              execl("./process.out", "process.out", NULL);
-            } else {  // Parent
-              currently = true;
-              process.startTime = oldClk;
-              process.PID = process_id;
-              process.state = _RUNNING;
-              printf("At time = %d, new process with ID = %d started running\n",
-                     oldClk, process.id);
-            }
-          }
-        }
-      }
-      /************************************************************************/
-    }
-    /**************************************************************************/
-  }
+/**
+ * @brief Returns the worker of a finished process to the pool.
+ *
+ * @param process Pointer to the PCB of the process.
+ */
+void releaseProcess(struct PCB* process) {
+  WorkerPool_release(&pool, process->worker);
+  process->worker = -1;
 }
 
 /**
- * @brief Round-Robin (RR) scheduling algorithm.
+ * @brief Reads the remaining time of the running process, as published by
+ * its worker at the current engine step.
  *
- * This function implements the Round-Robin scheduling algorithm for process
- * management and execution. It handles processes received from a message
- * queue, manages their execution using forked processes, and ensures fair
- * allocation of CPU time using a fixed time quantum.
+ * @param process Pointer to the PCB of the process.
+ * @return Remaining time of the process.
+ */
+int progressProcess(struct PCB* process) {
+  return WorkerPool_progress(&pool, process->worker, engine.oldClk);
+}
+
+#ifdef SCHED_PROBES
+/**
+ * @brief Asks the scheduler to dump its probes at the next event, so the
+ * latencies can be read while it runs (kill -USR1).
  *
- * The function manages process forking, signaling (SIGSTOP, SIGCONT,
- * SIGKILL), and updates the state of each process in a circular queue.
+ * @param signum The signal number.
+ */
+void requestProbes(int signum) { dumpProbes = 1; }
+#endif
+
+/**
+ * @brief Drives the scheduling engine with the live clock.
  *
  * @details
- * - Initializes necessary variables and structures for managing the
- * algorithm.
- * - Continuously receives processes until all processes are received and the
- *   circular queue is empty, while ensuring currently running processes are
- *   managed according to the Round-Robin scheduling policy.
- * - Iterates in time steps (quantumSize) and handles process forking,
- *   execution, pausing, and resuming.
+ * - Continuously receives processes until all processes are received and
+ *   the engine has nothing left to run; the processes of a time step are
+ *   admitted together.
+ * - Runs an engine step whenever the clock reaches the next time step of the
+ *   algorithm (every tick for HPF and SRTN, every quantum for RR).
+ * - Sleeps on the clock page whenever there is nothing to do.
+ * - Publishes its state in the stats page after every step and every batch
+ *   of arrivals.
  *
  * @note
- * - Uses functions like getClk() to get current clock time.
- * - Uses fork(), execl() for process creation and execution.
- * - Uses kill() to manage process states (SIGSTOP, SIGCONT, SIGKILL).
- *
- * @warning
- * - Uses SIGKILL to forcefully terminate processes.
+ * - The scheduling decisions are made by the engine (Engine.h), which the
+ *   simulator shares, and applied to the workers of the pool.
  *
  * @param None
  * @return None
  */
-void RR(void) {
-  printf("============= RR =============\n");
-  /****************************** Initialization
-   * ******************************/
-  int oldClk = getClk();  /**< Clock counter */
-  struct PCB rec;         /**< PCB to receive processes */
-  struct Circ_Queue q;    /**< Circular queue to implement the algorithm */
-  struct PCB process;     /**< Process to be currently executed */
-  bool currently = false; /**< Currently running a process */
-  Circ_Queue_Init(&q);    /**< Initialize the priority queue */
-  process.id = -1;        /**< To disable unreasonable stopping */
-  /****************************************************************************/
-
-  while ((receivedProcesses < processNumber) || !Circ_Queue_isEmpty(&q) ||
-         (currently == true)) {
-    /***************************** Receive Process ****************************/
-    rec = rec_msg_queue();
-    if (rec.id != -1) {
-      Circ_Queue_enqueue(&q, rec);
-      /* Print Statement */
-      printf("At time = %d, received process with ID = %d\n", getClk(), rec.id);
-      if (currently == false) {
-        process = Circ_Queue_dequeue(&q);
-        process.memPointer = allocate(process.memory);
-        if (process.memPointer == NULL) {
-          Circ_Queue_enqueue(&q, process);
-        } else {
-          int process_id = fork();
-          if (process_id == -1) {
-            perror("Error in forking of a process ");
-            exit(-1);
-          } else if (process_id == 0) {  // Child
-            execl("./process.out", "process.out", NULL);
-          } else {  // Parent
-            currently = true;
-            process.startTime = oldClk;
-            process.PID = process_id;
-            process.state = _RUNNING;
-            printf("At time = %d, new process with ID = %d started running\n",
-                   oldClk, process.id);
-          }
-        }
-      }
+void schedule(void) {
+  while (!allReceived || !Engine_isIdle(&engine)) {
+    /* Read the event counter before looking for work */
+    int seen = getEvents();
+    /**************************** Receive Processes ***************************/
+    int count = receiveProcesses(engine.oldClk);
+    if (count > 0) {
+      PROBE_BEGIN(arrive);
+      Engine_arrive(&engine, arrivals, count, arrivalsTick);
+      PROBE_END(_PROBE_ARRIVE, arrive);
+      StatsPage_publish(stats, &engine, false);
     }
     /**************************************************************************/
 
-    /******************************* TIME STEP  *******************************/
-    if (getClk() - oldClk == quantumSize) {
-      Circ_Queue_Inc_WaitingTime(&q, oldClk);
-      oldClk = getClk();
-
-      /***************************** PAUSE RUNNING ****************************/
-      if (process.id != -1 && process.state == _RUNNING) {
-        currently = false;
-        /* Pause it from running */
-        kill(process.PID, SIGSTOP);
-        /* Decrement the remaining time */
-        process.remainingTime -= quantumSize;
-        if (process.remainingTime <= 0) {
-          /* Kill the process */
-          kill(process.PID, SIGKILL);
-          /* Deallocate the memory */
-          deallocate(process.memPointer);
-          /* Print statement */
-          printf("At time = %d, process with ID = %d, has finished\n", oldClk,
-                 process.id);
-        } else {
-          /* Set its state to ready to be run */
-          process.state = _READY;
-          /* Insert it back into the queue */
-          Circ_Queue_enqueue(&q, process);
-          /* Print statement */
-          printf("At time = %d, ID = %d, remaining time = %d\n", oldClk,
-                 process.id, process.remainingTime);
-        }
-      }
-      /************************************************************************/
-
-      /************************** NORMAL PROCESSING  **************************/
-      process = Circ_Queue_dequeue(&q);
-      if (process.id != -1) {
-        process.memPointer = allocate(process.memory);
-        if (process.state == _READY) {
-          currently = true;
-          process.state = _RUNNING;
-          kill(process.PID, SIGCONT);
-        } else if (process.state == _NEW) {
-          if (process.memPointer == NULL) {
-            Circ_Queue_enqueue(&q, process);
-          } else {
-            int process_id = fork();
-            if (process_id == -1) {
-              perror("Error in forking of a process ");
-              exit(-1);
-            } else if (process_id == 0) {  // Child
-              execl("./process.out", "process.out", NULL);
-            } else {  // Parent
-              currently = true;
-              process.startTime = oldClk;
-              process.PID = process_id;
-              process.state = _RUNNING;
-              printf("At time = %d, new process with ID = %d started running\n",
-                     oldClk, process.id);
-            }
-          }
-        }
-      }
-      /************************************************************************/
+    /******************************** TIME STEP *******************************/
+    if (getClk() - engine.oldClk == engine.timeStep) {
+      PROBE_BEGIN(step);
+      Engine_step(&engine, getClk());
+      PROBE_END(_PROBE_STEP, step);
+      PROBE_END(_PROBE_TICK, clockPage->tickTime);
+      StatsPage_publish(stats, &engine, false);
     }
     /**************************************************************************/
+
+#ifdef SCHED_PROBES
+    if (dumpProbes) {
+      dumpProbes = 0;
+      Probe_write(__PROBES_FILE__);
+    }
+#endif
+    /* Sleep until the clock ticks or new processes are sent */
+    if (rec_val == -1) {
+      waitEvent(seen);
+    }
   }
-}
\ No newline at end of file
+}
@@ -0,0 +1,273 @@
+/**
+ * @file simulator.c
+ * @brief Runs HPF, SRTN, RR, MLFQ or CFS as a discrete-event simulation,
+ * without a clock process, a message queue or any forked process.
+ *
+ * The simulator drives the same engine as the scheduler (Engine.h), so it
+ * produces the same schedule, but it jumps straight from one event (an
+ * arrival, a completion, a quantum expiry or a boost) to the next one instead
+ * of waiting for the clock.
+ */
+
+#include "headers.h"
+
+#include "Engine.h"
+#include "Workload.h"
+
+/******************** MACROS ********************/
+#define __PROCESSES_FILE__ "processes.txt" /**< Default processes file */
+/************************************************/
+
+/*************** Global Variables ***************/
+static int algo;               // NOLINT
+static int quantumSize = 1;    // NOLINT
+static int cpus = 1;           // NOLINT
+static const char* levels;     // NOLINT
+static int boostPeriod = -1;   // NOLINT
+static int latency;            // NOLINT
+static int granularity;        // NOLINT
+static size_t memorySize;      // NOLINT
+static size_t minBlockSize;    // NOLINT
+static const char* fileName;   // NOLINT
+static bool quiet;             // NOLINT
+static const char* traceName;  // NOLINT
+static const char* perfName;   // NOLINT
+static struct Trace trace;     // NOLINT
+static struct Engine engine;   // NOLINT
+static struct PCB* batch;      // NOLINT
+static int batchCapacity;      // NOLINT
+/************************************************/
+
+/************* Function Definitions *************/
+void parseOptions(int argc, char* argv[]);
+bool readProcess(Workload* file, struct PCB* pcb);
+void ignoreProcess(struct PCB* process);
+void reserveBatch(int count);
+void simulate(Workload* file);
+/************************************************/
+
+int main(int argc, char* argv[]) {
+  parseOptions(argc, argv);
+  Workload file;
+  Workload_open(&file, fileName);
+  initializeBuddyAllocator(memorySize, minBlockSize);
+  /* No progress hook: the engine counts the remaining time down itself */
+  Engine_Hooks hooks = {ignoreProcess, ignoreProcess, ignoreProcess,
+                        ignoreProcess, NULL};
+  Engine_Init(&engine, algo, quantumSize, cpus, 0, hooks,
+              !quiet && traceName == NULL);
+  Engine_setLevels(&engine, levels, boostPeriod);
+  Engine_setFair(&engine, latency, granularity);
+  if (traceName != NULL) {
+    Trace_open(&trace, traceName, algo, cpus);
+    Engine_setTrace(&engine, &trace);
+  }
+  simulate(&file);
+  if (traceName != NULL) {
+    Trace_close(&trace);
+  }
+  Workload_close(&file);
+  free(batch);
+  Engine_printSummary(&engine);
+  if (perfName != NULL) {
+    Engine_writePerf(&engine, perfName);
+  }
+  Engine_destroy(&engine);
+  printMemoryStats();
+  return 0;
+}
+
+/**
+ * @brief Parses the command line options.
+ *
+ * - `-a <algo>` Scheduling algorithm: 0 HPF, 1 SRTN, 2 RR, 3 MLFQ, 4 CFS
+ *   (default 0).
+ * - `-q <quantum>` Quantum size for Round Robin, and of the top MLFQ level
+ *   (default 1).
+ * - `-l <quanta>` MLFQ quantum of every level from the top one, e.g. 2,4,8
+ *   (default three levels doubling the quantum).
+ * - `-B <period>` Time steps between two MLFQ boosts, 0 to never boost
+ *   (default 100).
+ * - `-L <latency>` CFS target latency in time steps (default 6).
+ * - `-G <granularity>` CFS minimum time slice (default 1).
+ * - `-f <file>` Processes file (default processes.txt).
+ * - `-m <size>` Size of the simulated memory (default TOTAL_MEMORY_SIZE).
+ * - `-b <size>` Minimum block size of the buddy allocator (default
+ *   MINIMUM_BLOCK_SIZE).
+ * - `-c <count>` Number of CPUs, each with its own ready queue (default 1).
+ * - `-s` Print the summary only, which lets the simulation skip the time
+ *   steps where only the running process advances.
+ * - `-T <file>` Record the events in a binary trace instead of printing
+ *   them; with -s, the skipped time steps are not recorded either.
+ * - `-P <file>` Write the performance report, as scheduler.perf of the
+ *   scheduler.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ */
+void parseOptions(int argc, char* argv[]) {
+  memorySize = TOTAL_MEMORY_SIZE;
+  minBlockSize = MINIMUM_BLOCK_SIZE;
+  fileName = __PROCESSES_FILE__;
+  int option;
+  while ((option = getopt(argc, argv, "a:q:f:m:b:c:l:B:L:G:sT:P:")) != -1) {
+    switch (option) {
+      case 'a':
+        algo = atoi(optarg);
+        break;
+      case 'q':
+        quantumSize = atoi(optarg);
+        break;
+      case 'f':
+        fileName = optarg;
+        break;
+      case 'm':
+        memorySize = parseSize(optarg);
+        break;
+      case 'b':
+        minBlockSize = parseSize(optarg);
+        break;
+      case 'c':
+        cpus = atoi(optarg);
+        break;
+      case 'l':
+        levels = optarg;
+        break;
+      case 'B':
+        boostPeriod = atoi(optarg);
+        break;
+      case 'L':
+        latency = atoi(optarg);
+        break;
+      case 'G':
+        granularity = atoi(optarg);
+        break;
+      case 's':
+        quiet = true;
+        break;
+      case 'T':
+        traceName = optarg;
+        break;
+      case 'P':
+        perfName = optarg;
+        break;
+      default:
+        fprintf(stderr,
+                "Usage: %s [-a algo] [-q quantum] [-f file] [-m memory_size] "
+                "[-b min_block_size] [-c cpus] [-l quanta] [-B boost] "
+                "[-L latency] [-G granularity] [-s] [-T trace] "
+                "[-P perf]\n",
+                argv[0]);
+        exit(-1);
+    }
+  }
+  if (algo < __HPF__ || algo > __CFS__ || quantumSize < 1) {
+    fprintf(stderr, "Invalid algorithm or quantum size\n");
+    exit(-1);
+  }
+  if (cpus < 1 || cpus > __MAX_CPUS__) {
+    fprintf(stderr, "The number of CPUs must be from 1 to %d\n", __MAX_CPUS__);
+    exit(-1);
+  }
+}
+
+/**
+ * @brief Reads the next process of the processes file.
+ *
+ * @param file The processes file.
+ * @param pcb Pointer to the PCB to be filled.
+ * @return true if a process was read, false at the end of the file.
+ */
+bool readProcess(Workload* file, struct PCB* pcb) {
+  struct ProcessRecord record;
+  if (!Workload_next(file, &record)) {
+    return false;
+  }
+  pcb->id = record.id;
+  pcb->arrivalTime = record.arrivalTime;
+  pcb->runTime = record.runTime;
+  pcb->prio = record.prio;
+  pcb->memory = record.memory;
+  return true;
+}
+
+/**
+ * @brief Hook for the actions on real processes, which do not exist here.
+ *
+ * @param process Pointer to the PCB of the process.
+ */
+void ignoreProcess(struct PCB* process) { process->PID = 0; }
+
+/**
+ * @brief Makes sure the batch buffer can hold the given number of processes.
+ *
+ * @param count Number of processes to be held.
+ */
+void reserveBatch(int count) {
+  if (count <= batchCapacity) {
+    return;
+  }
+  int newCapacity = batchCapacity == 0 ? 64 : batchCapacity * 2;
+  batch = (struct PCB*)realloc(batch,
+                               newCapacity * sizeof(struct PCB));  // NOLINT
+  if (batch == NULL) {
+    perror("Error in allocating the batch");
+    exit(-1);
+  }
+  batchCapacity = newCapacity;
+}
+
+/**
+ * @brief Runs the simulation until every process of the file finished.
+ *
+ * @details
+ * - At every time step, the engine step comes first and the arrivals of the
+ *   step follow as one batch, in the same order as in the live scheduler.
+ * - Time steps where nothing can happen are skipped: with no process running,
+ *   the simulation jumps to the next arrival, and in quiet mode it also jumps
+ *   over the steps where the running process only advances.
+ * - Processes are read from the file as they arrive, so the memory used does
+ *   not grow with the length of the file.
+ *
+ * @param file The processes file.
+ */
+void simulate(Workload* file) {
+  struct PCB next; /**< Next process to arrive */
+  bool pending = readProcess(file, &next);
+  int clk = 0;
+  while (pending || !Engine_isIdle(&engine)) {
+    if (clk - engine.oldClk == engine.timeStep) {
+      Engine_step(&engine, clk);
+    }
+    int count = 0;
+    while (pending && next.arrivalTime <= clk) {
+      reserveBatch(count + 1);
+      batch[count++] = next;
+      pending = readProcess(file, &next);
+    }
+    if (count > 0) {
+      Engine_arrive(&engine, batch, count, clk);
+    }
+    /************************* Jump to the next event *************************/
+    int target = clk + 1;
+    if (quiet || engine.running == 0) {
+      target = Engine_nextEvent(&engine);
+      if (pending && next.arrivalTime < target) {
+        target = next.arrivalTime;
+      }
+      if (target == INT_MAX) {
+        if (Engine_isIdle(&engine)) {
+          break;
+        }
+        fprintf(stderr, "At time = %d, no process can ever run again\n", clk);
+        exit(-1);
+      }
+      if (target <= clk) {
+        target = clk + 1;
+      }
+      Engine_skip(&engine, target);
+    }
+    clk = target;
+    /**************************************************************************/
+  }
+}
@@ -1,35 +1,504 @@
-#include <stdio.h>
-#include <stdlib.h>
+/**
+ * @file test_generator.c
+ * @brief Generates a processes file for tests and benchmarks.
+ *
+ * Arrivals follow a Poisson process, a bursty process or uniform gaps, run
+ * times a uniform, Pareto or lognormal distribution, and memory sizes a
+ * bimodal distribution of small and large requests, all set from the command
+ * line. The processes are generated in chunks, each one from its own random
+ * streams, so a seed gives the same file whatever the number of threads.
+ */
+
+#include <math.h>
+#include <pthread.h>
 #include <time.h>
-#define null 0
 
-struct processData {
-  int arrivaltime;
-  int priority;
-  int runningtime;
-  int id;
-  int memory;
-};
+#include "headers.h"
+
+#include "Workload.h"
+
+/******************** MACROS ********************/
+#define __CHUNK_SIZE__ (1 << 18)  /**< Processes generated by one task */
+#define __MAX_THREADS__ 64        /**< Largest number of threads */
+#define __MAX_RUNTIME__ 1000000   /**< Longest run time generated */
+#define __MAX_PRIORITY__ 10       /**< Lowest priority generated */
+/************************************************/
+
+/**
+ * @brief Enum defining the models of the arrival times.
+ */
+typedef enum ArrivalModel {
+  _POISSON_ARRIVALS = 0, /**< Exponential gaps */
+  _BURSTY_ARRIVALS = 1,  /**< Bursts of geometric size at exponential gaps */
+  _UNIFORM_ARRIVALS = 2  /**< Uniform gaps */
+} ArrivalModel;
+
+/**
+ * @brief Enum defining the distributions of the run times.
+ */
+typedef enum RuntimeModel {
+  _UNIFORM_RUNTIME = 0,  /**< Uniform */
+  _PARETO_RUNTIME = 1,   /**< Pareto, heavy-tailed */
+  _LOGNORMAL_RUNTIME = 2 /**< Lognormal, heavy-tailed */
+} RuntimeModel;
+
+/**
+ * @brief Random stream (xoshiro256**).
+ */
+typedef struct Rng {
+  unsigned long long s[4]; /**< State */
+} Rng;
+
+/**
+ * @brief Processes generated by one task.
+ */
+typedef struct Chunk {
+  long long first;  /**< Index of the first process */
+  int count;        /**< Number of processes */
+  Rng arrivals;     /**< Stream of the arrival times */
+  Rng attributes;   /**< Stream of the run times, priorities and memory */
+  double start;     /**< Time the arrivals of the chunk count from */
+  double span;      /**< Time from the start to the last arrival */
+} Chunk;
+
+/**
+ * @brief Work of one thread: a chunk and the buffers it is generated into.
+ */
+typedef struct Task {
+  struct Chunk* chunk;           /**< Chunk to be generated */
+  struct ProcessRecord* records; /**< Generated processes */
+  char* text;                    /**< Processes in the text format */
+  size_t length;                 /**< Length of the text */
+} Task;
+
+/*************** Global Variables ***************/
+static long long processesNum = -1;                    // NOLINT
+static const char* fileName = "processes.txt";         // NOLINT
+static bool binary;                                    // NOLINT
+static unsigned long long seed;                        // NOLINT
+static ArrivalModel arrivalModel = _POISSON_ARRIVALS;  // NOLINT
+static double arrivalRate = 0.2;                       // NOLINT
+static double burstSize = 20;                          // NOLINT
+static RuntimeModel runtimeModel = _UNIFORM_RUNTIME;   // NOLINT
+static double meanRuntime = 15;                        // NOLINT
+static double paretoShape = 1.5;                       // NOLINT
+static double lognormalSigma = 1;                      // NOLINT
+static int maxMemory = 256;                            // NOLINT
+static double largeFraction = 0.1;                     // NOLINT
+static int threadsNum = 1;                             // NOLINT
+/************************************************/
+
+/************* Function Definitions *************/
+void parseOptions(int argc, char* argv[]);
+unsigned long long Rng_next(Rng* rng);
+void Rng_seed(Rng* rng, unsigned long long value);
+void Rng_jump(Rng* rng);
+double Rng_uniform(Rng* rng);
+double nextArrival(Rng* rng, double time, int* burstLeft);
+int sampleRuntime(Rng* rng);
+int sampleMemory(Rng* rng);
+void* measureChunk(void* arg);
+void* fillChunk(void* arg);
+void runTasks(void* (*work)(void*), Task* tasks, int count);
+/************************************************/
 
 int main(int argc, char* argv[]) {
-  FILE* pFile = NULL;
-  pFile = fopen("processes.txt", "w");
-  int no = 0;
-  struct processData pData;
-  printf("Please enter the number of processes you want to generate: ");
-  scanf("%d", &no);  // NOLINT
-  srand(time(null));
-  fprintf(pFile, "#id arrival runtime priority memory\n");
-  pData.arrivaltime = 1;
-  for (int i = 1; i <= no; i++) {
-    // generate Data Randomly
-    pData.id = i;
-    pData.arrivaltime += rand() % (11);  // processes arrives in order
-    pData.runningtime = rand() % (30);
-    pData.priority = rand() % (11);
-    pData.memory = rand() % (256);
-    fprintf(pFile, "%d\t%d\t%d\t%d\t%d\n", pData.id, pData.arrivaltime,
-            pData.runningtime, pData.priority, pData.memory);
-  }
-  fclose(pFile);
+  seed = (unsigned long long)time(NULL);
+  parseOptions(argc, argv);
+  if (processesNum < 0) {
+    printf("Please enter the number of processes you want to generate: ");
+    if (scanf("%lld", &processesNum) != 1 || processesNum < 0) {  // NOLINT
+      fprintf(stderr, "Invalid number of processes\n");
+      exit(-1);
+    }
+  }
+  /* Give every chunk its own streams, so the output does not depend on the
+   * number of threads */
+  int chunksNum = (int)((processesNum + __CHUNK_SIZE__ - 1) / __CHUNK_SIZE__);
+  Chunk* chunks = (Chunk*)calloc(chunksNum > 0 ? chunksNum : 1,  // NOLINT
+                                 sizeof(Chunk));
+  Task* tasks = (Task*)calloc(threadsNum, sizeof(Task));  // NOLINT
+  if (chunks == NULL || tasks == NULL) {
+    perror("Memory allocation failed");
+    exit(-1);
+  }
+  Rng rng;
+  Rng_seed(&rng, seed);
+  for (int c = 0; c < chunksNum; c++) {
+    chunks[c].first = (long long)c * __CHUNK_SIZE__;
+    chunks[c].count = (int)(processesNum - chunks[c].first < __CHUNK_SIZE__
+                                ? processesNum - chunks[c].first
+                                : __CHUNK_SIZE__);
+    chunks[c].arrivals = rng;
+    Rng_jump(&rng);
+    chunks[c].attributes = rng;
+    Rng_jump(&rng);
+  }
+  /* First pass: the time each chunk spans, to know where the next starts */
+  for (int c = 0; c < chunksNum; c += threadsNum) {
+    int count = chunksNum - c < threadsNum ? chunksNum - c : threadsNum;
+    for (int t = 0; t < count; t++) {
+      tasks[t].chunk = &chunks[c + t];
+    }
+    runTasks(measureChunk, tasks, count);
+  }
+  double start = 1;
+  for (int c = 0; c < chunksNum; c++) {
+    chunks[c].start = start;
+    start += chunks[c].span;
+  }
+  if (start >= (double)INT_MAX) {
+    fprintf(stderr, "The arrival times do not fit in an int\n");
+    exit(-1);
+  }
+  /* Second pass: generate the chunks, then write them in order */
+  for (int t = 0; t < threadsNum; t++) {
+    tasks[t].records = (struct ProcessRecord*)malloc(  // NOLINT
+        __CHUNK_SIZE__ * sizeof(struct ProcessRecord));
+    tasks[t].text = binary ? NULL
+                           : (char*)malloc(__CHUNK_SIZE__ *  // NOLINT
+                                           WORKLOAD_LINE_MAX);
+    if (tasks[t].records == NULL || (!binary && tasks[t].text == NULL)) {
+      perror("Memory allocation failed");
+      exit(-1);
+    }
+  }
+  WorkloadWriter writer;
+  WorkloadWriter_open(&writer, fileName, binary);
+  for (int c = 0; c < chunksNum; c += threadsNum) {
+    int count = chunksNum - c < threadsNum ? chunksNum - c : threadsNum;
+    for (int t = 0; t < count; t++) {
+      tasks[t].chunk = &chunks[c + t];
+    }
+    runTasks(fillChunk, tasks, count);
+    for (int t = 0; t < count; t++) {
+      WorkloadWriter_writeBlock(&writer, tasks[t].records,
+                                tasks[t].chunk->count, tasks[t].text,
+                                tasks[t].length);
+    }
+  }
+  WorkloadWriter_close(&writer);
+  printf("%lld processes written to %s, arrivals from %d to %d, seed = %llu\n",
+         writer.header.count, fileName, writer.header.minArrival,
+         writer.header.maxArrival, seed);
+  for (int t = 0; t < threadsNum; t++) {
+    free(tasks[t].records);
+    free(tasks[t].text);
+  }
+  free(tasks);
+  free(chunks);
+  return 0;
+}
+
+/**
+ * @brief Parses the command line options.
+ *
+ * - `-n <count>` Number of processes; asked on stdin if missing.
+ * - `-o <file>` Output file (default processes.txt).
+ * - `-B` Write the binary format.
+ * - `-s <seed>` Seed of the random streams (default the current time).
+ * - `-a poisson|bursty|uniform` Arrival model (default poisson).
+ * - `-r <rate>` Mean number of arrivals per time step (default 0.2).
+ * - `-k <size>` Mean number of processes in a burst (default 20).
+ * - `-d uniform|pareto|lognormal` Run time distribution (default uniform).
+ * - `-R <mean>` Mean run time (default 15).
+ * - `-p <shape>` Shape of the Pareto distribution, above 1 (default 1.5).
+ * - `-g <sigma>` Sigma of the lognormal distribution (default 1).
+ * - `-M <bytes>` Largest memory request (default 256).
+ * - `-L <fraction>` Fraction of large memory requests (default 0.1).
+ * - `-j <threads>` Number of threads (default 1).
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ */
+void parseOptions(int argc, char* argv[]) {
+  int option;
+  while ((option = getopt(argc, argv, "n:o:Bs:a:r:k:d:R:p:g:M:L:j:")) != -1) {
+    switch (option) {
+      case 'n':
+        processesNum = atoll(optarg);
+        break;
+      case 'o':
+        fileName = optarg;
+        break;
+      case 'B':
+        binary = true;
+        break;
+      case 's':
+        seed = strtoull(optarg, NULL, 10);
+        break;
+      case 'a':
+        if (strcmp(optarg, "poisson") == 0) {
+          arrivalModel = _POISSON_ARRIVALS;
+        } else if (strcmp(optarg, "bursty") == 0) {
+          arrivalModel = _BURSTY_ARRIVALS;
+        } else if (strcmp(optarg, "uniform") == 0) {
+          arrivalModel = _UNIFORM_ARRIVALS;
+        } else {
+          fprintf(stderr, "Unknown arrival model %s\n", optarg);
+          exit(-1);
+        }
+        break;
+      case 'r':
+        arrivalRate = atof(optarg);
+        break;
+      case 'k':
+        burstSize = atof(optarg);
+        break;
+      case 'd':
+        if (strcmp(optarg, "uniform") == 0) {
+          runtimeModel = _UNIFORM_RUNTIME;
+        } else if (strcmp(optarg, "pareto") == 0) {
+          runtimeModel = _PARETO_RUNTIME;
+        } else if (strcmp(optarg, "lognormal") == 0) {
+          runtimeModel = _LOGNORMAL_RUNTIME;
+        } else {
+          fprintf(stderr, "Unknown run time distribution %s\n", optarg);
+          exit(-1);
+        }
+        break;
+      case 'R':
+        meanRuntime = atof(optarg);
+        break;
+      case 'p':
+        paretoShape = atof(optarg);
+        break;
+      case 'g':
+        lognormalSigma = atof(optarg);
+        break;
+      case 'M':
+        maxMemory = atoi(optarg);
+        break;
+      case 'L':
+        largeFraction = atof(optarg);
+        break;
+      case 'j':
+        threadsNum = atoi(optarg);
+        break;
+      default:
+        fprintf(stderr,
+                "Usage: %s [-n count] [-o file] [-B] [-s seed] "
+                "[-a poisson|bursty|uniform] [-r rate] [-k burst_size] "
+                "[-d uniform|pareto|lognormal] [-R mean_runtime] "
+                "[-p pareto_shape] [-g lognormal_sigma] [-M max_memory] "
+                "[-L large_fraction] [-j threads]\n",
+                argv[0]);
+        exit(-1);
+    }
+  }
+  if (processesNum > INT_MAX || arrivalRate <= 0 || burstSize < 1 ||
+      meanRuntime < 1 || paretoShape <= 1 || lognormalSigma < 0 ||
+      maxMemory < 1 || largeFraction < 0 || largeFraction > 1 ||
+      threadsNum < 1 || threadsNum > __MAX_THREADS__) {
+    fprintf(stderr, "Invalid generator parameters\n");
+    exit(-1);
+  }
+}
+
+/**
+ * @brief Returns the next 64 random bits of a stream.
+ *
+ * @param rng Pointer to the stream.
+ * @return Random bits.
+ */
+unsigned long long Rng_next(Rng* rng) {
+  unsigned long long* s = rng->s;
+  unsigned long long x = s[1] * 5;
+  unsigned long long result = ((x << 7) | (x >> 57)) * 9;
+  unsigned long long t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = (s[3] << 45) | (s[3] >> 19);
+  return result;
+}
+
+/**
+ * @brief Seeds a stream, spreading the seed over the state with splitmix64.
+ *
+ * @param rng Pointer to the stream.
+ * @param value Seed.
+ */
+void Rng_seed(Rng* rng, unsigned long long value) {
+  for (int i = 0; i < 4; i++) {
+    unsigned long long z = (value += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    rng->s[i] = z ^ (z >> 31);
+  }
+}
+
+/**
+ * @brief Advances a stream by 2^128 steps, which starts a stream that does
+ * not overlap with it.
+ *
+ * @param rng Pointer to the stream.
+ */
+void Rng_jump(Rng* rng) {
+  static const unsigned long long jump[4] = {
+      0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL,
+      0x39abdc4529b1661cULL};
+  unsigned long long s[4] = {0, 0, 0, 0};
+  for (int i = 0; i < 4; i++) {
+    for (int b = 0; b < 64; b++) {
+      if (jump[i] & (1ULL << b)) {
+        for (int k = 0; k < 4; k++) {
+          s[k] ^= rng->s[k];
+        }
+      }
+      Rng_next(rng);
+    }
+  }
+  memcpy(rng->s, s, sizeof(s));
+}
+
+/**
+ * @brief Returns a uniform number in (0, 1].
+ *
+ * @param rng Pointer to the stream.
+ * @return Random number.
+ */
+double Rng_uniform(Rng* rng) {
+  return (double)((Rng_next(rng) >> 11) + 1) * 0x1.0p-53;
+}
+
+/**
+ * @brief Returns the time of the arrival following the one at a given time.
+ *
+ * @param rng Pointer to the stream of the arrival times.
+ * @param time Time of the previous arrival.
+ * @param burstLeft Pointer to the number of processes left in the current
+ * burst.
+ * @return Time of the next arrival.
+ */
+double nextArrival(Rng* rng, double time, int* burstLeft) {
+  if (arrivalModel == _POISSON_ARRIVALS) {
+    return time - log(Rng_uniform(rng)) / arrivalRate;
+  }
+  if (arrivalModel == _UNIFORM_ARRIVALS) {
+    return time + Rng_uniform(rng) * 2 / arrivalRate;
+  }
+  if (*burstLeft > 0) {
+    (*burstLeft)--;
+    return time;
+  }
+  /* A new burst, whose size is geometric with mean burstSize */
+  if (burstSize > 1) {
+    *burstLeft = (int)(log(Rng_uniform(rng)) / log(1 - 1 / burstSize));
+  }
+  return time - log(Rng_uniform(rng)) * burstSize / arrivalRate;
+}
+
+/**
+ * @brief Draws a run time from the chosen distribution with the chosen mean.
+ *
+ * @param rng Pointer to the stream of the attributes.
+ * @return Run time, between 1 and __MAX_RUNTIME__.
+ */
+int sampleRuntime(Rng* rng) {
+  double runtime;
+  if (runtimeModel == _PARETO_RUNTIME) {
+    double scale = meanRuntime * (paretoShape - 1) / paretoShape;
+    runtime = scale / pow(Rng_uniform(rng), 1 / paretoShape);
+  } else if (runtimeModel == _LOGNORMAL_RUNTIME) {
+    /* Box-Muller transform */
+    double normal = sqrt(-2 * log(Rng_uniform(rng))) *
+                    cos(2 * M_PI * Rng_uniform(rng));
+    double mu = log(meanRuntime) - lognormalSigma * lognormalSigma / 2;
+    runtime = exp(mu + lognormalSigma * normal);
+  } else {
+    runtime = 1 + Rng_uniform(rng) * (2 * meanRuntime - 1);
+  }
+  if (runtime < 1) {
+    return 1;
+  }
+  return runtime > __MAX_RUNTIME__ ? __MAX_RUNTIME__ : (int)runtime;
+}
+
+/**
+ * @brief Draws a memory size: mostly small requests, up to an eighth of
+ * maxMemory, and a fraction of large ones, above half of it.
+ *
+ * @param rng Pointer to the stream of the attributes.
+ * @return Memory size, between 1 and maxMemory.
+ */
+int sampleMemory(Rng* rng) {
+  bool large = (bool)(Rng_uniform(rng) <= largeFraction);
+  int low = large ? maxMemory / 2 + 1 : 1;
+  int high = large ? maxMemory : (maxMemory / 8 > 0 ? maxMemory / 8 : 1);
+  return low + (int)((Rng_uniform(rng) - 0x1.0p-53) * (high - low + 1));
+}
+
+/**
+ * @brief Computes the time a chunk spans, from its start to its last arrival.
+ *
+ * @param arg Pointer to the task of the chunk.
+ * @return NULL.
+ */
+void* measureChunk(void* arg) {
+  Chunk* chunk = ((Task*)arg)->chunk;
+  Rng rng = chunk->arrivals;
+  int burstLeft = 0;
+  double time = 0;
+  for (int i = 0; i < chunk->count; i++) {
+    time = nextArrival(&rng, time, &burstLeft);
+  }
+  chunk->span = time;
+  return NULL;
+}
+
+/**
+ * @brief Generates the processes of a chunk, and formats them for the text
+ * format.
+ *
+ * @param arg Pointer to the task of the chunk.
+ * @return NULL.
+ */
+void* fillChunk(void* arg) {
+  Task* task = (Task*)arg;
+  Chunk* chunk = task->chunk;
+  Rng arrivals = chunk->arrivals;
+  Rng attributes = chunk->attributes;
+  int burstLeft = 0;
+  double time = 0;
+  task->length = 0;
+  for (int i = 0; i < chunk->count; i++) {
+    struct ProcessRecord* record = &task->records[i];
+    time = nextArrival(&arrivals, time, &burstLeft);
+    record->id = (int)(chunk->first + i + 1);
+    record->arrivalTime = (int)(chunk->start + time);
+    record->runTime = sampleRuntime(&attributes);
+    record->prio = (int)(Rng_next(&attributes) % (__MAX_PRIORITY__ + 1));
+    record->memory = sampleMemory(&attributes);
+    if (task->text != NULL) {
+      task->length += WorkloadWriter_format(task->text + task->length, record);
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Runs a task per chunk, in parallel if more than one.
+ *
+ * @param work Function run on every task.
+ * @param tasks Tasks to run.
+ * @param count Number of tasks.
+ */
+void runTasks(void* (*work)(void*), Task* tasks, int count) {
+  if (count == 1) {
+    work(&tasks[0]);
+    return;
+  }
+  pthread_t threads[__MAX_THREADS__];
+  for (int t = 0; t < count; t++) {
+    if (pthread_create(&threads[t], NULL, work, &tasks[t]) != 0) {
+      perror("Error in creating a thread");
+      exit(-1);
+    }
+  }
+  for (int t = 0; t < count; t++) {
+    pthread_join(threads[t], NULL);
+  }
 }